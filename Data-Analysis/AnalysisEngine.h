@@ -0,0 +1,154 @@
+/*********************AnalysisEngine.h******************
+ *
+ * Compiled version of RunStatsPmt and xyrad_histo of EventAnalysis.C.
+ * Both analyses are done in a single multi-threaded pass over run<SiRunNumber>.root
+ * (ROOT::RDataFrame with EnableImplicitMT), reading only the branches they use.
+ * Every thread fills its own copy of the histograms, which are merged at the end.
+ *
+ * The histograms have the same names of the macro and are written in
+ * run<SiRunNumber>_Results/run<SiRunNumber>_analysis.root, in the directories
+ * RunStatsPmt and xyrad_histo.
+ ********************************************************/
+
+#ifndef AnalysisEngine_h
+#define AnalysisEngine_h
+
+#include <vector>
+#include "TH1F.h"
+#include "TH2F.h"
+#include "TString.h"
+#include "ROOT/RVec.hxx"
+
+namespace Analysis {
+
+typedef ROOT::VecOps::RVec<Double_t> RVecD;
+typedef ROOT::VecOps::RVec<Int_t>    RVecI;
+
+const Int_t nSiLayers = 2;
+const Int_t nChannelsPmt = 26;
+const Int_t activeChannels[26] = {21,22,29,30,37,38,45,46,5,6,13,14,53,54,61,62,40,39,32,31,24,23,16,15,7,8};
+//////run300128
+const Double_t xcenterRadiator = 4.96292;
+const Double_t ycenterRadiator = 3.97302;
+
+const Double_t Sidistx = 12.05;
+const Double_t Sidisty = 8.7;
+
+//Cuts of xyrad_histo
+typedef struct {
+	Double_t thr_theta;
+	Double_t thr_Radiator;
+	Double_t thr_x0;
+	Double_t thr_y0;
+} Cuts_t;
+
+//One event, as read from the tree
+typedef struct {
+	Long64_t       entry;      //entry of the tree (evNumber-1 only if the run starts from event 1)
+	Int_t          evNumber;
+	Double_t       xRadiator;
+	Double_t       yRadiator;
+	Double_t       theta;
+	Double_t       trgUp;
+	Double_t       trgDown;
+	Double_t       Dinode;
+	const Double_t *xHit;
+	const Double_t *yHit;
+	const Double_t *PmtTime;
+	const Double_t *PulseHeight;
+	const Int_t    *DgtzID;
+} Event_t;
+
+//Set of histograms of one thread: the histograms are booked in the same order
+//by every thread, so that they can be merged one by one
+class HistoSet {
+public:
+	virtual ~HistoSet();
+	void Merge(HistoSet *other);
+	void Write();
+protected:
+	TH1F* book(const char* name, const char* title, Int_t nBins, Double_t min, Double_t max);
+	TH2F* book(const char* name, const char* title, Int_t nxBins, Double_t xmin, Double_t xmax, Int_t nyBins, Double_t ymin, Double_t ymax);
+	std::vector<TH1*> histos;
+};
+
+//Histograms of RunStatsPmt
+class PmtStats : public HistoSet {
+public:
+	PmtStats();
+	void Fill(const Event_t &ev);
+	void Merge(PmtStats *other);
+	TH1F* PmtTime_Histo[nChannelsPmt];
+	TH1F* PmtPulseHeight_Histo[nChannelsPmt];
+	TH1F* PmtPulseHeight_HistoInTime[nChannelsPmt];
+	Long64_t evCounter; //events with all the channels in the time window
+};
+
+//Histograms of xyrad_histo
+class XyRad : public HistoSet {
+public:
+	XyRad(const Cuts_t &cuts);
+	void Fill(const Event_t &ev);
+	void Merge(XyRad *other);
+	Cuts_t cuts;
+	std::vector<Int_t> selectedEvents;
+	std::vector<Long64_t> selectedEntries; //entries of the tree of the selected events
+	//hit projection on radiator
+	TH1F *xRadiator_Histo, *yRadiator_Histo;
+	TH1F *xRadiator_HistoInRange, *yRadiator_HistoInRange;
+	TH1F *xRadiator_HistoInSpacialRange, *yRadiator_HistoInSpacialRange;
+	TH1F *xRadiator_HistoInAngularRange, *yRadiator_HistoInAngularRange;
+	TH2F *xyRadiator_Histo, *xyRadiator_HistoInRange, *xyRadiator_HistoBkg;
+	TH1F *xRadiator_HistoWeighted, *yRadiator_HistoWeighted;
+	TH2F *xyRadiator_HistoWeighted;
+	//hit on Silicon detetcors
+	TH1F *x0Hit_Histo, *x1Hit_Histo, *y0Hit_Histo, *y1Hit_Histo;
+	TH1F *x0Hit_HistoInRange, *x1Hit_HistoInRange, *y0Hit_HistoInRange, *y1Hit_HistoInRange;
+	TH1F *x0Hit_HistoInAngularRange, *x1Hit_HistoInAngularRange, *y0Hit_HistoInAngularRange, *y1Hit_HistoInAngularRange;
+	TH1F *x0Hit_HistoInSpacialRange, *x1Hit_HistoInSpacialRange, *y0Hit_HistoInSpacialRange, *y1Hit_HistoInSpacialRange;
+	TH2F *xy0_Histo, *xy1_Histo, *xy0_HistoInRange, *xy1_HistoInRange, *xy0_HistoBkg, *xy1_HistoBkg;
+	//theta
+	TH1F *theta_Histo, *theta_HistoInRange, *theta_HistoInSpacialRange, *theta_HistoInAngularRange;
+	TH2F *thetaZX_vs_PmtIntegratedPulseHeight, *thetaZY_vs_PmtIntegratedPulseHeight;
+	TH2F *thetaZX_vs_thetaZY_Histo, *thetaZX_vs_thetaZY_HistoWeighted;
+	TH1F *thetaZX_Histo, *thetaZY_Histo, *thetaZX_HistoWeighted, *thetaZY_HistoWeighted;
+	//trigger
+	TH1F *trgUp_Histo, *trgUp_HistoInSpacialRange, *trgUp_HistoInAngularRange, *trgUp_HistoInRange;
+	TH1F *trgDown_Histo, *trgDown_HistoInSpacialRange, *trgDown_HistoInAngularRange, *trgDown_HistoInRange, *trgDown_HistoOut;
+	TH1F *Dinode_Histo, *Dinode_HistoInSpacialRange, *Dinode_HistoInAngularRange, *Dinode_HistoInRange;
+	TH1F *Dinode_HistoLower, *Dinode_HistoUpper;
+	TH1F *trgSignal_Histo, *trgSignal_HistoInSpacialRange, *trgSignal_HistoInAngularRange, *trgSignal_HistoInRange;
+	// Pmt pulse height
+	TH1F *PmtIntegratedPulseHeight_HistoInRange, *PmtIntegratedPulseHeight_HistoLower, *PmtIntegratedPulseHeight_HistoUpper;
+	TH1F* PmtPulseHeight_HistoInRange[nChannelsPmt];
+	TH1F* PmtPulseHeight_HistoLower[nChannelsPmt];
+	TH1F* PmtPulseHeight_HistoUpper[nChannelsPmt];
+};
+
+//Columns of the events with all the Pmt channels in time, cached for the cut scan
+class ScanColumns {
+public:
+	void Add(const Event_t &ev);
+	void Append(const ScanColumns &other);
+	size_t size() const { return theta.size(); }
+	std::vector<Double_t> theta;
+	std::vector<Double_t> d2Radiator;    //squared distance from the centre of the radiator
+	std::vector<Double_t> dx0, dy0;      //distance from the centre (5,5) of the UPPER Si
+	std::vector<Double_t> IntegratedSignal;
+	std::vector<Char_t>   bkgSide;       //-1 Lower, +1 Upper, 0 outside the background regions
+};
+
+//All the Pmt channels in the time window of their digitizer
+bool AllChannelsInTime(const Event_t &ev);
+
+//Fills RunStatsPmt and xyrad_histo in one pass over the run file and writes the results.
+//nThreads=0 uses all the cores.
+void RunAnalysis(Int_t SiRunNumber, const Cuts_t &cuts, Int_t nThreads=0);
+
+//Selected events, integrated Pmt PH and background of xyrad_histo for every point of the
+//grid of cuts, with one pass over the run file
+void ScanCuts(Int_t SiRunNumber, const std::vector<Cuts_t> &grid, Int_t nThreads=0);
+
+}
+
+#endif
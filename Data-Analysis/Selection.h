@@ -0,0 +1,50 @@
+/*********************Selection.h******************
+ *
+ * The events selected by xyrad_histo (and by Analysis::RunAnalysis) are saved as
+ * TEntryList in run<SiRunNumber>_selections.root, next to the run file. The name of
+ * a selection is made with its cuts, with the distances in mm as in the txt files:
+ * xyrad_histo(300128,0.99,2.0,10.0,10.0) --> sel_theta9900_Radiator20mm_x0_100mm_y0_100mm
+ *
+ * The entries of a TEntryList are sorted, so a selection is read sequentially:
+ *   for(Long64_t i=0; i<list->GetN(); ++i) intree->GetEntry(list->GetEntry(i));
+ ***************************************************/
+
+#ifndef Selection_h
+#define Selection_h
+
+#include <iostream>
+#include "TFile.h"
+#include "TEntryList.h"
+#include "TString.h"
+
+inline TString SelectionName(Double_t thr_theta, Double_t thr_Radiator, Double_t thr_x0, Double_t thr_y0) {
+	return Form("sel_theta%.0f_Radiator%.0fmm_x0_%.0fmm_y0_%.0fmm",thr_theta*10000,thr_Radiator*10,thr_x0*10,thr_y0*10);
+}
+
+//Empty selection of the tree of the run
+inline TEntryList* NewSelection(Int_t SiRunNumber, TString name) {
+	return new TEntryList(name,name,"Cherenkov",Form("run%i.root",SiRunNumber));
+}
+
+//Writes the selection in run<SiRunNumber>_selections.root, replacing the one with the same name
+inline void SaveSelection(Int_t SiRunNumber, TEntryList* list) {
+	TFile* file = new TFile(Form("run%i_selections.root",SiRunNumber),"UPDATE");
+	list->Write(list->GetName(),TObject::kOverwrite);
+	file->Close();
+	delete file;
+	std::cout << "Selection " << list->GetName() << " (" << list->GetN() << " events) saved in run" << SiRunNumber << "_selections.root" << std::endl;
+}
+
+//Selection of run<SiRunNumber>_selections.root, NULL if it does not exist
+inline TEntryList* LoadSelection(Int_t SiRunNumber, TString name) {
+	TFile* file = new TFile(Form("run%i_selections.root",SiRunNumber),"READ");
+	TEntryList* list = NULL;
+	if(file->IsOpen()) list = (TEntryList*)file->Get(name);
+	if(list) list->SetDirectory(0);
+	else std::cout << "ERROR: no selection " << name << " in run" << SiRunNumber << "_selections.root" << std::endl;
+	file->Close();
+	delete file;
+	return list;
+}
+
+#endif
@@ -0,0 +1,175 @@
+#include "AcceptanceTable.h"
+#include "Random.h"
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+static const int magic   = 0x544c4843; //"CHLT"
+static const int version = 1;
+
+AcceptanceTable::AcceptanceTable( int nSamples ) : nSamples( nSamples ) {
+    
+}
+
+long AcceptanceTable::bin( double r, double z, double theta, double phi ) {
+    
+    int ir = (int)( r/geometry[1]*nR );
+    int iz = (int)( z/geometry[2]*nZ );
+    //bins of theta: nTheta/4 in [0,theta_c], nTheta/2 in [theta_c,pi-theta_c], nTheta/4 in [pi-theta_c,pi]
+    int    q  = nTheta/4;
+    int    ic;
+    if( theta < theta_c )           ic = (int)( theta/theta_c*q );
+    else if( theta < M_PI-theta_c ) ic = q + (int)( ( theta-theta_c )/( M_PI-2*theta_c )*2*q );
+    else                            ic = 3*q + (int)( ( theta-M_PI+theta_c )/theta_c*q );
+    int ip = (int)( phi/( 2*M_PI )*nPhi );
+    //the points on the upper edges go in the last bin
+    ir = std::max( 0, std::min( ir, nR-1 ) );
+    iz = std::max( 0, std::min( iz, nZ-1 ) );
+    ic = std::max( 0, std::min( ic, nTheta-1 ) );
+    ip = std::max( 0, std::min( ip, nPhi-1 ) );
+    return ( ( (long)ir*nZ + iz )*nTheta + ic )*nPhi + ip;
+}
+
+double AcceptanceTable::thetaEdge( int i ) {
+    
+    int q = nTheta/4;
+    if( i <= q )   return theta_c*i/q;
+    if( i <= 3*q ) return theta_c + ( M_PI-2*theta_c )*( i-q )/( 2*q );
+    return M_PI - theta_c + theta_c*( i-3*q )/q;
+}
+
+bool AcceptanceTable::loadOrBuild( std::string file_name, Setup* setup, ThreadPool* pool ) {
+    
+    geometry[0] = setup->getRefractionIndex();
+    geometry[1] = setup->getRadius();
+    geometry[2] = setup->getHeight();
+    geometry[3] = setup->getPMdistance();
+    geometry[4] = setup->ReflectionThreshold();
+    theta_c     = setup->getCriticalAngle();
+    
+    if( read( file_name ) ) {
+        std::cout << "* Acceptance table read from " << file_name << std::endl;
+        return true;
+    }
+    std::cout << "* Building the acceptance table (" << (long)nR*nZ*nTheta*nPhi*nSamples << " photons)..." << std::endl;
+    build( setup, pool );
+    write( file_name );
+    std::cout << "* Acceptance table saved in " << file_name << ", acceptance " << getAcceptance() << std::endl;
+    return false;
+}
+
+void AcceptanceTable::build( Setup* setup, ThreadPool* pool ) {
+    
+    long nBins = (long)nR*nZ*nTheta*nPhi;
+    fates.assign( nBins*nSamples, Fate() );
+    
+    //each bin has its own random stream, independent of the seed of the run
+    pool->start( nBins, [&]( long iBin ) {
+        seedEvent( 0, iBin );
+        std::uniform_real_distribution<double> unif_dist(0,1);
+        int ip = iBin % nPhi;
+        int ic = ( iBin/nPhi ) % nTheta;
+        int iz = ( iBin/nPhi/nTheta ) % nZ;
+        int ir = iBin/nPhi/nTheta/nZ;
+        
+        for( int k = 0; k < nSamples; k++ ) {
+            //uniform in the area of the ring and in the solid angle
+            double r         = geometry[1]*sqrt( ( ir*ir + ( 2*ir+1 )*unif_dist( gen ) )/nR/nR );
+            double z         = geometry[2]*( iz + unif_dist( gen ) )/nZ;
+            double cos_min   = cos( thetaEdge( ic+1 ) );
+            double cos_max   = cos( thetaEdge( ic ) );
+            double cos_theta = cos_min + ( cos_max - cos_min )*unif_dist( gen );
+            double phi       = 2*M_PI*( ip + unif_dist( gen ) )/nPhi;
+            
+            Photon ph( Vector( r, 0, z ), 0, acos( cos_theta ), phi );
+            ph.rotateProjections( 0, 0 ); //the frame of the table is the global one
+            ph.tracePh<Cylinder>( setup );
+            
+            Fate& fate = fates[iBin*nSamples + k];
+            fate.position_out = ph.getPosition_out();
+            fate.nReflections = ph.getnReflections();
+            fate.x_out        = ph.getLastPosition()->getX();
+            fate.y_out        = ph.getLastPosition()->getY();
+            fate.dphi_out     = ph.getPhiOut_ph() - phi;
+        }
+    } );
+    pool->wait();
+}
+
+void AcceptanceTable::sample( Photon* ph, Setup* setup ) {
+    
+    //frame where the emission point is on the x axis
+    Vector* x_0 = ph->getLastPosition();
+    double  r   = sqrt( x_0->getX()*x_0->getX() + x_0->getY()*x_0->getY() );
+    double  c   = ( r > 0 ) ? x_0->getX()/r : 1;
+    double  s   = ( r > 0 ) ? x_0->getY()/r : 0;
+    double  ux  =  ph->dir_x*c + ph->dir_y*s;
+    double  uy  = -ph->dir_x*s + ph->dir_y*c;
+    double  phi = atan2( uy, ux );
+    if( phi < 0 ) phi += 2*M_PI;
+    double  theta = acos( ph->dir_z );
+    
+    std::uniform_int_distribution<int> pick( 0, nSamples-1 );
+    Fate& fate = fates[bin( r, x_0->getZ(), theta, phi )*nSamples + pick( gen )];
+    
+    ph->position_out = fate.position_out;
+    ph->nReflections = fate.nReflections;
+    if( fate.position_out == 1 ) {
+        //refraction towards the PM plane with the exact angle of the photon (as in Particle::hitPM),
+        //then back to the frame of the emission point
+        double phi_out     = phi + fate.dphi_out;
+        double theta_prime = asin( ph->getRefractionIndex( setup )*sin( theta ) );
+        double shift       = setup->getPMdistance()*tan( theta_prime );
+        double x_PM        = fate.x_out + shift*cos( phi_out );
+        double y_PM        = fate.y_out + shift*sin( phi_out );
+        ph->theta_ph_out = theta;
+        ph->phi_ph_out   = atan2( s, c ) + phi_out;
+        ph->nPos++;
+        ph->x = Vector( x_PM*c - y_PM*s, x_PM*s + y_PM*c, setup->getHeight() + setup->getPMdistance() );
+        ph->position.push_back( ph->x );
+    }
+}
+
+double AcceptanceTable::getAcceptance() {
+    
+    long nPM = 0;
+    for( size_t i = 0; i < fates.size(); i++ ) {
+        if( fates[i].position_out == 1 ) nPM++;
+    }
+    return fates.size() ? (double)nPM/fates.size() : 0;
+}
+
+bool AcceptanceTable::read( std::string file_name ) {
+    
+    FILE* f = fopen( file_name.c_str(), "rb" );
+    if( !f ) return false;
+    
+    //the table is used only if it was built with the same binning and geometry
+    int    header[7];
+    double file_geometry[5];
+    bool   ok = fread( header, sizeof( int ), 7, f ) == 7 && fread( file_geometry, sizeof( double ), 5, f ) == 5;
+    ok = ok && header[0] == magic && header[1] == version && header[2] == nR && header[3] == nZ
+            && header[4] == nTheta && header[5] == nPhi && header[6] == nSamples;
+    for( int i = 0; ok && i < 5; i++ ) ok = ( file_geometry[i] == geometry[i] );
+    if( ok ) {
+        fates.resize( (long)nR*nZ*nTheta*nPhi*nSamples );
+        ok = fread( fates.data(), sizeof( Fate ), fates.size(), f ) == fates.size();
+    }
+    fclose( f );
+    if( !ok ) std::cout << "* " << file_name << " does not match the geometry of the run" << std::endl;
+    return ok;
+}
+
+void AcceptanceTable::write( std::string file_name ) {
+    
+    FILE* f = fopen( file_name.c_str(), "wb" );
+    if( !f ) {
+        std::cout << "* Unable to write the acceptance table in " << file_name << std::endl;
+        return;
+    }
+    int header[7] = { magic, version, nR, nZ, nTheta, nPhi, nSamples };
+    fwrite( header, sizeof( int ), 7, f );
+    fwrite( geometry, sizeof( double ), 5, f );
+    fwrite( fates.data(), sizeof( Fate ), fates.size(), f );
+    fclose( f );
+}
@@ -0,0 +1,59 @@
+#ifndef AcceptanceTable_h
+#define AcceptanceTable_h
+#include "Setup.h"
+#include "Photon.h"
+#include "ThreadPool.h"
+#include <string>
+#include <vector>
+
+//Table of the fate of the photons in a cylindrical radiator, for the transport LUT.
+//The cylinder is symmetric around its axis, so the fate of a photon depends only on the
+//distance r of the emission point from the axis, its depth z, the polar angle theta of the
+//direction and its azimuth phi relative to the radius of the emission point. For each bin of
+//(r, z, theta, phi) the table keeps a bank of photons transported with the full algorithm
+//(Photon::tracePh) from random points and directions inside the bin: where they went out,
+//their exit point on the bottom face and direction (in the frame where the emission point is
+//on the x axis) and the number of reflections. A new photon takes the fate of a random photon
+//of its bin, rotated to its emission point, so the pixel of the Pmt is found as with the full
+//transport. The reflections do not change |cos(theta)|, so the refraction towards the PM plane,
+//which is very sensitive to theta near the critical angle, is computed with the exact theta of
+//the photon. The total reflections on the top and bottom faces depend only on theta, so the
+//critical angles are edges of the bins of theta. The table is built once per geometry and
+//saved on disk.
+class AcceptanceTable {
+
+public:
+    AcceptanceTable( int nSamples = 8 );
+    //Reads the table from file; if the file is missing or was made for a different geometry,
+    //the table is built with the threads of the pool and saved in the file
+    bool loadOrBuild( std::string file_name, Setup* setup, ThreadPool* pool );
+    void sample( Photon* ph, Setup* setup ); //to be called after Photon::rotateProjections
+    double getAcceptance(); //fraction of the photons of the table reaching the PM plane
+    
+private:
+    struct Fate {
+        float x_out;        //exit point on the bottom face, in the frame of the emission point
+        float y_out;
+        float dphi_out;     //azimuth of the exit direction minus the azimuth of the emission
+        short position_out; //as in Photon
+        short nReflections;
+    };
+    
+    bool read( std::string file_name );  //the geometry to match is in geometry[], set by loadOrBuild
+    void build( Setup* setup, ThreadPool* pool );
+    void write( std::string file_name );
+    long bin( double r, double z, double theta, double phi );
+    double thetaEdge( int i ); //lower edge of the i-th bin of theta
+    
+    static const int nR     = 10;
+    static const int nZ     = 10;
+    static const int nTheta = 88;         //a quarter in each range of total reflection
+    static const int nPhi   = 24;
+    int    nSamples;                           //photons of each bin
+    double geometry[5];                        //n, r, h, PM distance, reflection threshold
+    double theta_c;                            //critical angle
+    std::vector<Fate> fates;                   //nSamples for each bin
+    
+};
+
+#endif
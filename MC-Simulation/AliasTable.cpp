@@ -0,0 +1,30 @@
+#include "AliasTable.h"
+
+void AliasTable::build( const std::vector<double>& weights ) {
+    
+    //Vose's method: the bins below the mean are filled up with the bins above it
+    int    n   = weights.size();
+    double sum = 0;
+    for( int i = 0; i < n; i++ ) sum += weights[i];
+    prob.assign( n, 1 );
+    alias.resize( n );
+    std::vector<double> scaled( n );
+    std::vector<int>    small, large;
+    for( int i = 0; i < n; i++ ) {
+        alias[i]  = i;
+        scaled[i] = weights[i]*n/sum;
+        if( scaled[i] < 1 ) small.push_back( i );
+        else                large.push_back( i );
+    }
+    while( !small.empty() && !large.empty() ) {
+        int s = small.back(); small.pop_back();
+        int l = large.back();
+        prob[s]  = scaled[s];
+        alias[s] = l;
+        scaled[l] -= 1 - scaled[s];
+        if( scaled[l] < 1 ) {
+            large.pop_back();
+            small.push_back( l );
+        }
+    }
+}
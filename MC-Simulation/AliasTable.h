@@ -0,0 +1,24 @@
+#ifndef AliasTable_h
+#define AliasTable_h
+#include <vector>
+
+//Table of a discrete distribution for the alias method (Walker, Vose): a bin is drawn in
+//constant time with a single uniform number, whatever the shape of the distribution
+class AliasTable {
+
+public:
+    void build( const std::vector<double>& weights );
+    //bin for the uniform number u in [0,1); u is also used for the choice between the bin and its alias
+    inline int sample( double u ) const {
+        double x = u*prob.size();
+        int    i = (int)x;
+        return ( x - i < prob[i] ) ? i : alias[i];
+    }
+    
+private:
+    std::vector<double> prob;
+    std::vector<int>    alias;
+    
+};
+
+#endif
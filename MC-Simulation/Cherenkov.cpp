@@ -1,81 +1,244 @@
 #include <iostream>
 #include <vector>
+#include <string>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Config.h"
 #include "Setup.h"
 #include "Vector.h"
 #include "Muon.h"
-#include "SaveTree.cpp"
+#include "SaveTree.h"
 #include "Photon.h"
+#include "Random.h"
+#include "Simulation.h"
+#include "ThreadPool.h"
+#include "Stats.h"
 
-int main( int argc, char* argv[] ) {
+//Simulates nEvents events with the parameters in config and saves them in the output file
+void runSimulation( ThreadPool* pool, Config* config, long nEvents ) {
     
     //Definition of particles
-    Particle::setParticlesData();
+    Particle::setParticlesData( config );
     
-    //Choice of number of events to be simulated
-    int nEvents = atoi( argv[1] );
+    SimOptions  options;
+    std::string transport = config->getString( "transport", "step" );
+    std::string muon      = config->getString( "muon", "full" );
+    options.seed = config->getULong( "seed", 0 );
+    if( transport == "step" ) options.transport = STEP;
+    else if( transport == "batch" ) options.transport = BATCH;
+    else if( transport == "trace" ) options.transport = TRACE;
+    else if( transport == "lut" ) options.transport = LUT;
+    else std::cout << "* Unknown transport " << transport << std::endl;
+    if( muon == "full" ) options.muon = FULL;
+    else if( muon == "fast" ) options.muon = FAST;
+    else std::cout << "* Unknown muon tracking " << muon << std::endl;
+    std::string termination = config->getString( "termination", "none" );
+    if( termination == "early" ) options.termination.early = true;
+    else if( termination != "none" ) std::cout << "* Unknown termination " << termination << std::endl;
+    options.termination.reflections = config->getLong( "roulette_reflections", 0 );
+    options.termination.survival    = config->getDouble( "roulette_survival", 0.5 );
+    if( options.termination.reflections > 0 && ( options.termination.survival <= 0 || options.termination.survival > 1 ) ) {
+        std::cout << "* The survival probability of the roulette must be in (0,1]: using 0.5" << std::endl;
+        options.termination.survival = 0.5;
+    }
     
-    std::cout << "******************** NEW SIMULATION! ********************" << std::endl;
-    std::cout << "* Number of events: " << nEvents << std::endl;
+    //Emission spectrum: each photon is transported with the index at its wavelength, the setup
+    //(muon fast mode, acceptance table) takes the mean index of the detected photons
+    Spectrum*   spectrum = NULL;
+    std::string emission = config->getString( "emission", "fixed" );
+    if( emission == "spectrum" ) {
+        spectrum = new Spectrum( config );
+        if( spectrum->isLoaded() ) {
+            options.spectrum = spectrum;
+            config->set( "n", std::to_string( spectrum->getMeanIndex() ) );
+        } else std::cout << "* Using one wavelength for all the photons" << std::endl;
+    } else if( emission != "fixed" ) std::cout << "* Unknown emission " << emission << std::endl;
     
     //Choice of the setup geometry
-    Setup* setup = new Setup( argv[2], argv[3] );
+    Setup* setup = new Setup( config );
     
-    std::vector<Muon*>* muList = new std::vector<Muon*>();
+    //Generator of the muons
+    CosmicGenerator* generator = NULL;
+    std::string      muonGenerator = config->getString( "generator", "fixed" );
+    if( muonGenerator == "cosmic" ) {
+        generator = new CosmicGenerator( setup, config );
+        options.generator = generator;
+    } else if( muonGenerator != "fixed" ) std::cout << "* Unknown generator " << muonGenerator << std::endl;
     
-    for( int i=0; i<nEvents; i++ ) {
-        
-        std::cout << "* ...generating event " << i+1 << std::endl;
-        
-        //Generation and propagation of muons
-        Vector* x_0   = setup->generateInitialPoint();
-        double* angle = setup->generateInitialAngle(); // element 0 = theta, element 1 = phi
-        
-        Muon* mu = new Muon( x_0, 4000, angle[0], angle[1] );
-        mu->updatePosition();
-        
-        while ( setup->checkPosition( mu->getLastPosition() ) == true ) {
-            //Generation of Cherenkov photons
-            mu->Cherenkov( setup->getRefractionIndex() ); 
-            mu->updatePosition();
+    //The transport LUT needs the acceptance table of the geometry, which is built if needed
+    AcceptanceTable* table = NULL;
+    if( options.transport == LUT && setup->getGeometry() != CYLINDER ) {
+        std::cout << "* The transport lut needs a cylinder: using trace" << std::endl;
+        options.transport = TRACE;
+    } else if( options.transport == LUT ) {
+        if( config->getString( "save", "full" ) != "hits" ) std::cout << "* The transport lut does not simulate the trajectories: use --save hits" << std::endl;
+        table = new AcceptanceTable( config->getLong( "lut_samples", 8 ) );
+        table->loadOrBuild( config->getString( "lut", "./output/acceptance.lut" ), setup, pool );
+        options.table = table;
+    }
+    
+    std::string file_name = config->getString( "output", "./output/Cherenkov_MC.root" );
+    std::string save      = config->getString( "save", "full" );
+    //the events are numbered from first_event: a shard of a run simulates exactly the events
+    //(and the random streams) it would simulate in a single run with the same seed
+    long        first     = config->getLong( "first_event", 1 );
+    std::cout << "* Output file: " << file_name << std::endl;
+    if( save != "full" && save != "hits" ) std::cout << "* Unknown save mode " << save << std::endl;
+    SaveTree* saveTree = new SaveTree( file_name, save == "hits" );
+    resetStats();
+    
+    //The threads put the simulated events in a ring of slots; this thread saves them in 
+    //order and deletes them. A thread cannot start an event more than 'window' events
+    //ahead of the last saved one, so at most 'window' events are kept in memory.
+    const long         window = 4*pool->getNThreads();
+    std::vector<Muon*> slots( window, NULL );
+    long               nSaved = 0;
+    std::mutex         mtx;
+    std::condition_variable cv;
+    
+    pool->start( nEvents, [&]( long i ) {
+        {
+            std::unique_lock<std::mutex> lock( mtx );
+            cv.wait( lock, [&]{ return i < nSaved + window; } );
+        }
+        Muon* mu = simulateEvent( setup, &options, first-1+i );
+        {
+            std::lock_guard<std::mutex> lock( mtx );
+            slots[i % window] = mu;
+        }
+        cv.notify_all();
+    } );
+    
+    std::cout << "* Saving events!" << std::endl;
+    long nPhotons = 0, nPM = 0;
+    for( long i = 0; i < nEvents; i++ ) {
+        Muon* mu;
+        {
+            std::unique_lock<std::mutex> lock( mtx );
+            cv.wait( lock, [&]{ return slots[i % window] != NULL; } );
+            mu = slots[i % window];
+            slots[i % window] = NULL;
         }
         
-        mu->hitPM( setup->getPMdistance(), angle[0], angle[1] );
-        //Propagation of photons
-        std::vector<Photon*>* phList = mu->getPhotonList();
+        //Save the event in the root TTree and release it
+        std::vector<Photon>* phList = mu->getPhotonList();
+        nPhotons += phList->size();
+        for( int j = 0; j < phList->size(); j++ ) if( phList->at( j ).getPosition_out() == 1 ) nPM++;
+        saveTree->fillEvent( mu, first+i );
+        delete mu;
         
-        for( int j=0; j < phList->size(); j++ ) {
-            //new projections in the global rf
-            phList->at( j )->rotateProjections( angle[0], angle[1] ); 
-            while( setup->checkPosition( phList->at( j )->getLastPosition() ) == true ) {
-                //new position in the global rf
-                phList->at( j )->updatePositionPh( angle[0], angle[1], setup);
-            }
-            if( phList->at( j )->getPosition_out() == 1 ) {
-                double theta_prime = asin( setup->getRefractionIndex()*sin( phList->at( j )->getThetaOut_ph() ) );
-                double phi_prime   = phList->at( j )->getPhiOut_ph();
-                
-                phList->at( j )->hitPM( setup->getPMdistance(), theta_prime, phi_prime );
-            }  
+        {
+            std::lock_guard<std::mutex> lock( mtx );
+            nSaved = i+1;
         }
+        cv.notify_all();
         
-        muList->push_back( mu );
+        if( (i+1) % 1000 == 0 ) std::cout << "* ..." << int( (i+1)*100.0/nEvents ) << "\% saved" << std::endl;
     }
+    pool->wait();
+    
+    std::cout << "* Photons on the PM: " << double( nPM )/nEvents << " per event" << std::endl;
+    if( nPhotons > 0 && nPM == 0 ) std::cout << "* None of the " << nPhotons << " photons reached the PM: check --n or --dispersion" << std::endl;
+    
+    saveTree->close();
+    delete saveTree;
+    delete table;
+    delete generator;
+    delete spectrum;
+    delete setup;
+    std::cout << "* ...100\% completed!" << std::endl;
+    printStats( config->getString( "stats_json", "" ) );
+}
+
+int main( int argc, char* argv[] ) {
+    
+    //Choice of number of events to be simulated
+    int nEvents = atoi( argv[1] );
     
-    //Save events in a root TTree
-    int maxPos = 0;
-    for(int m = 0; m < muList->size(); m++) {
+    //Parameters of the run: first the configuration file, then the command line
+    Config config;
+    for( int i = 4; i+1 < argc; i += 2 ) {
+        if( strcmp( argv[i], "--config" ) == 0 ) config.readFile( argv[i+1] );
+    }
+    config.set( "detector", argv[2] );
+    config.set( "walls", argv[3] );
     
-        Muon* mu = muList->at(m);
-        int maxPos_temp = mu->nPos;
-        std::vector<Photon*>* photons = mu->getPhotonList();
-        for(int p = 0; p < photons->size(); p++) {
-            if(photons->at(p)->nPos > maxPos_temp) maxPos_temp = photons->at(p)->nPos;
+    std::vector<std::string>                scan_keys;   //parameters of the scan
+    std::vector< std::vector<std::string> > scan_values; //values of each parameter
+    for( int i = 4; i+1 < argc; i += 2 ) {
+        if( strcmp( argv[i], "--config" ) == 0 ) continue;
+        if( strcmp( argv[i], "--scan" ) == 0 ) {
+            //--scan key=value1,value2,...
+            std::string scan  = argv[i+1];
+            size_t      equal = scan.find( '=' );
+            if( equal == std::string::npos ) {
+                std::cout << "* Wrong scan " << scan << ", expected key=value1,value2,..." << std::endl;
+                continue;
+            }
+            scan_keys.push_back( scan.substr( 0, equal ) );
+            scan_values.push_back( std::vector<std::string>() );
+            size_t first = equal+1;
+            while( first <= scan.size() ) {
+                size_t comma = scan.find( ',', first );
+                if( comma == std::string::npos ) comma = scan.size();
+                scan_values.back().push_back( scan.substr( first, comma-first ) );
+                first = comma+1;
+            }
+        }
+        else if( strncmp( argv[i], "--", 2 ) == 0 ) {
+            //--first-event is the same of --first_event
+            std::string key = argv[i]+2;
+            std::replace( key.begin(), key.end(), '-', '_' );
+            config.set( key, argv[i+1] );
         }
-        if(maxPos_temp > maxPos) maxPos = maxPos_temp;
+        else std::cout << "* Unknown option " << argv[i] << std::endl;
+    }
+    if( !config.has( "seed" ) ) config.set( "seed", std::to_string( generateSeed() ) );
+    //the shards of a run do not overwrite each other if the output is not given
+    if( config.has( "first_event" ) && !config.has( "output" ) ) {
+        long first = config.getLong( "first_event", 1 );
+        config.set( "output", "./output/Cherenkov_MC_events" + std::to_string( first ) + "-" + std::to_string( first+nEvents-1 ) + ".root" );
+    }
     
+    std::cout << "******************** NEW SIMULATION! ********************" << std::endl;
+    std::cout << "* Number of events: " << nEvents << std::endl;
+    std::cout << "* Parameters:" << std::endl;
+    config.print();
+    
+    ThreadPool pool( config.getLong( "threads", std::thread::hardware_concurrency() ) );
+    std::cout << "* Number of threads: " << pool.getNThreads() << std::endl;
+    
+    //Scan: all the combinations of the values are simulated with the same seed, each one
+    //in its own output file, named after the output file and the values of the point
+    long nPoints = 1;
+    for( int k = 0; k < scan_keys.size(); k++ ) nPoints *= scan_values[k].size();
+    
+    for( long iPoint = 0; iPoint < nPoints; iPoint++ ) {
+        
+        Config      point     = config;
+        std::string file_name = config.getString( "output", "./output/Cherenkov_MC.root" );
+        std::string suffix    = "";
+        long        index     = iPoint;
+        for( int k = 0; k < scan_keys.size(); k++ ) {
+            std::string value = scan_values[k][index % scan_values[k].size()];
+            index /= scan_values[k].size();
+            point.set( scan_keys[k], value );
+            suffix += "_" + scan_keys[k] + value;
+        }
+        
+        if( scan_keys.size() > 0 ) {
+            size_t dot = file_name.rfind( ".root" );
+            if( dot == std::string::npos ) dot = file_name.size();
+            point.set( "output", file_name.substr( 0, dot ) + suffix + file_name.substr( dot ) );
+            std::cout << "******************** SCAN POINT " << iPoint+1 << "/" << nPoints << " ********************" << std::endl;
+        }
+        
+        runSimulation( &pool, &point, nEvents );
     }
-    SaveTree( muList, maxPos );
 
     std::cout << "*********************************************************" << std::endl;
     
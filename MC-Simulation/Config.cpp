@@ -0,0 +1,87 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include "Config.h"
+
+//Parameters known by the code: a misspelled key is reported instead of being ignored
+static const char* known_keys[] = {
+    "detector", "walls", "n", "r", "h", "d", "PMdistance", "reflection_threshold",
+    "muon_step", "photon_step", "output", "threads", "seed", "transport", "muon", "stats_json",
+    "save", "lut", "lut_samples", "first_event",
+    "generator", "gen_emin", "gen_emax", "emission", "dispersion", "qe",
+    "termination", "roulette_reflections", "roulette_survival"
+};
+
+static std::string trim( std::string s ) {
+    size_t first = s.find_first_not_of( " \t\r" );
+    if( first == std::string::npos ) return "";
+    size_t last = s.find_last_not_of( " \t\r" );
+    return s.substr( first, last-first+1 );
+}
+
+Config::Config() {
+    
+}
+
+bool Config::readFile( std::string file_name ) {
+    
+    std::ifstream file( file_name.c_str() );
+    if( !file.is_open() ) {
+        std::cout << "* Cannot open the configuration file " << file_name << std::endl;
+        return false;
+    }
+    
+    std::string line;
+    int nLine = 0;
+    while( std::getline( file, line ) ) {
+        nLine++;
+        line = trim( line.substr( 0, line.find( '#' ) ) );
+        if( line.empty() ) continue;
+        
+        size_t equal = line.find( '=' );
+        if( equal == std::string::npos ) {
+            std::cout << "* " << file_name << ":" << nLine << ": expected key = value" << std::endl;
+            continue;
+        }
+        set( trim( line.substr( 0, equal ) ), trim( line.substr( equal+1 ) ) );
+    }
+    
+    return true;
+}
+
+void Config::set( std::string key, std::string value ) {
+    
+    bool known = false;
+    for( int i = 0; i < sizeof( known_keys )/sizeof( known_keys[0] ); i++ ) {
+        if( key == known_keys[i] ) known = true;
+    }
+    if( !known ) std::cout << "* Unknown parameter " << key << std::endl;
+    
+    values[key] = value;
+}
+
+bool Config::has( std::string key ) {
+    return values.count( key ) > 0;
+}
+
+std::string Config::getString( std::string key, std::string def ) {
+    return has( key ) ? values[key] : def;
+}
+
+double Config::getDouble( std::string key, double def ) {
+    return has( key ) ? atof( values[key].c_str() ) : def;
+}
+
+long Config::getLong( std::string key, long def ) {
+    return has( key ) ? atol( values[key].c_str() ) : def;
+}
+
+unsigned long Config::getULong( std::string key, unsigned long def ) {
+    return has( key ) ? strtoul( values[key].c_str(), NULL, 10 ) : def;
+}
+
+void Config::print() {
+    for( std::map<std::string, std::string>::iterator it = values.begin(); it != values.end(); it++ ) {
+        std::cout << "*   " << it->first << " = " << it->second << std::endl;
+    }
+}
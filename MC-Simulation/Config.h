@@ -0,0 +1,28 @@
+#ifndef Config_h
+#define Config_h
+#include <string>
+#include <map>
+
+//Parameters of the run, read from a configuration file and from the command line.
+//The file contains one parameter per line in the form "key = value"; everything after
+//a '#' is a comment. A value set later (e.g. from the command line) overrides the
+//previous one. The parameters which are not set take the default value of the code.
+class Config {
+
+public:
+    Config();
+    bool          readFile( std::string file_name );
+    void          set( std::string key, std::string value );
+    bool          has( std::string key );
+    std::string   getString( std::string key, std::string def );
+    double        getDouble( std::string key, double def );
+    long          getLong( std::string key, long def );
+    unsigned long getULong( std::string key, unsigned long def );
+    void          print();
+    
+private:
+    std::map<std::string, std::string> values;
+    
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "CosmicGenerator.h"
+#include "Random.h"
+#include <cmath>
+#include <iostream>
+
+CosmicGenerator::CosmicGenerator( Setup* setup, Config* config ) : nPhi( 720 ) {
+    
+    radius = setup->getRadius();
+    box    = ( setup->getGeometry() == BOX );
+    
+    //energy spectrum
+    const int nEnergy = 2000;
+    double emin = config->getDouble( "gen_emin", 200 );   //MeV
+    double emax = config->getDouble( "gen_emax", 1e6 );   //MeV
+    dlogEnergy  = log( emax/emin )/nEnergy;
+    logEnergy.resize( nEnergy );
+    std::vector<double> weights( nEnergy );
+    for( int i = 0; i < nEnergy; i++ ) {
+        logEnergy[i] = log( emin ) + i*dlogEnergy;
+        double E     = exp( logEnergy[i] + dlogEnergy/2 )/1000; //GeV, centre of the bin
+        double width = E*dlogEnergy;
+        weights[i]   = pow( E + 2, -2.7 )*( 1/( 1 + 1.1*E/115 ) + 0.054/( 1 + 1.1*E/850 ) )*width;
+    }
+    energyTable.build( weights );
+    
+    //azimuth: the integral of cos^3 sin up to the max angle is (1 - cos^4)/4
+    cos4Max.resize( nPhi );
+    weights.resize( nPhi );
+    for( int i = 0; i < nPhi; i++ ) {
+        double c   = cos( setup->getMaxAngle( 2*M_PI*( i + 0.5 )/nPhi ) );
+        cos4Max[i] = c*c*c*c;
+        weights[i] = 1 - cos4Max[i];
+    }
+    phiTable.build( weights );
+    
+    std::cout << "* Cosmic muons: energy " << emin << " - " << emax << " MeV" << std::endl;
+}
+
+void CosmicGenerator::generate( int n, const double* u, double* x, double* y, double* theta, double* phi, double* energy ) {
+    
+    const double* uEnergy = u;
+    const double* uLogE   = u + n;
+    const double* uPhi    = u + 2*n;
+    const double* uPhiBin = u + 3*n;
+    const double* uTheta  = u + 4*n;
+    const double* uX      = u + 5*n;
+    const double* uY      = u + 6*n;
+    
+    for( int i = 0; i < n; i++ ) {
+        //energy: bin from the alias table, uniform in log(E) inside the bin
+        int k     = energyTable.sample( uEnergy[i] );
+        energy[i] = exp( logEnergy[k] + dlogEnergy*uLogE[i] );
+        
+        //azimuth, then zenith: cos^4(theta) is uniform between cos^4(max angle) and 1
+        int j    = phiTable.sample( uPhi[i] );
+        phi[i]   = 2*M_PI*( j + uPhiBin[i] )/nPhi;
+        theta[i] = acos( sqrt( sqrt( 1 - uTheta[i]*( 1 - cos4Max[j] ) ) ) );
+        
+        //entry point: uniform on the disc (the radius goes as the sqrt of a uniform number) or on the square
+        double rho = radius*sqrt( uX[i] );
+        double a   = 2*M_PI*uY[i];
+        x[i] = box ? radius*( uX[i] - 0.5 ) : rho*cos( a );
+        y[i] = box ? radius*( uY[i] - 0.5 ) : rho*sin( a );
+    }
+}
+
+void CosmicGenerator::generate( Vector* x_0, double* angle, double* energy ) {
+    
+    std::uniform_real_distribution<double> unif_dist(0,1);
+    double u[nUniform];
+    for( int k = 0; k < nUniform; k++ ) u[k] = unif_dist( gen );
+    double x, y;
+    generate( 1, u, &x, &y, &angle[0], &angle[1], energy );
+    *x_0 = Vector( x, y, 0 );
+}
@@ -0,0 +1,42 @@
+#ifndef CosmicGenerator_h
+#define CosmicGenerator_h
+#include "Setup.h"
+#include "Config.h"
+#include "Vector.h"
+#include "AliasTable.h"
+#include <vector>
+
+//Generator of cosmic muons with tables computed once for the setup, so that each muon is
+//drawn in constant time and without rejections:
+// - energy: spectrum of the muons at sea level, Gaisser's formula for vertical muons with the
+//   energy shifted by the loss in the atmosphere,
+//   dN/dE ~ (E + 2 GeV)^-2.7 ( 1/(1 + 1.1E/115 GeV) + 0.054/(1 + 1.1E/850 GeV) ),
+//   tabulated in logarithmic bins between gen_emin and gen_emax (alias table)
+// - azimuth: bins of phi weighted by the acceptance of the trigger (alias table)
+// - zenith: flux through the top face of the radiator ~ cos^3(theta) sin(theta) up to the
+//   maximum angle of the trigger (Setup::getMaxAngle), with the inverse of its cumulative
+// - entry point: uniform on the top face of the radiator
+//The dependence of the energy spectrum on the zenith angle is neglected.
+class CosmicGenerator {
+
+public:
+    CosmicGenerator( Setup* setup, Config* config );
+    void generate( Vector* x_0, double* angle, double* energy ); //one muon (energy in MeV)
+    //n muons from the uniform numbers u[k*n+i], k = 0..nUniform-1: the loop has no branches and
+    //the compiler can vectorize it
+    void generate( int n, const double* u, double* x, double* y, double* theta, double* phi, double* energy );
+    static const int nUniform = 7;          //uniform numbers for each muon
+    
+private:
+    double      radius;                     //radius (c) or side (p) of the top face
+    bool        box;
+    AliasTable  energyTable;
+    std::vector<double> logEnergy;          //lower edges of the energy bins, log(MeV)
+    double      dlogEnergy;
+    AliasTable  phiTable;
+    std::vector<double> cos4Max;            //cos^4 of the max zenith angle at the centre of each bin of phi
+    int         nPhi;
+    
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef Geometry_h
+#define Geometry_h
+#include <cmath>
+
+//Shapes of the radiator. The functions which move the photons are templates on the shape:
+//they are compiled once for each shape and the shape is chosen once per event, so the
+//inner loops do not test the type of detector. A new shape needs a struct with the same
+//members, a value of GeometryType and the explicit instantiations of the templates.
+//The tests are written with & instead of && so that the loops on many photons can be
+//vectorized.
+enum GeometryType { CYLINDER, BOX };
+
+//Cylinder of radius r and height h, with the axis along z
+struct Cylinder {
+    
+    static const bool lateralReflections = true; //the reflections on the lateral walls are simulated
+    
+    static inline bool inside( double x, double y, double z, double r, double h ) {
+        return ( sqrt( x*x + y*y ) < r ) & ( z < h ) & ( z >= 0.0 );
+    }
+    
+    //distance from (x,y) inside to the lateral wall along (ux,uy)
+    static inline double lateralDistance( double x, double y, double ux, double uy, double r ) {
+        //(x + t*ux)^2 + (y + t*uy)^2 = r^2, the point is inside so the larger root is the one ahead
+        double a = ux*ux + uy*uy;
+        if( a <= 0 ) return INFINITY;
+        double b     = x*ux + y*uy;
+        double c     = x*x + y*y - r*r;
+        double delta = b*b - a*c;
+        return ( -b + sqrt( delta > 0 ? delta : 0 ) )/a;
+    }
+    
+};
+
+//Parallelepiped with a square basis of side r and height h
+struct Box {
+    
+    static const bool lateralReflections = false; //the lateral walls are always absorbing
+    
+    static inline bool inside( double x, double y, double z, double r, double h ) {
+        return ( fabs( x ) <= r/2 ) & ( fabs( y ) <= r/2 ) & ( z < h ) & ( z >= 0.0 );
+    }
+    
+    static inline double lateralDistance( double x, double y, double ux, double uy, double r ) {
+        double t = INFINITY;
+        if( ux > 0 ) t = ( r/2 - x )/ux;
+        if( ux < 0 ) t = ( -r/2 - x )/ux;
+        if( uy > 0 && ( r/2 - y )/uy < t ) t = ( r/2 - y )/uy;
+        if( uy < 0 && ( -r/2 - y )/uy < t ) t = ( -r/2 - y )/uy;
+        return t;
+    }
+    
+};
+
+#endif
@@ -1,34 +1,55 @@
 #include "Muon.h"
+#include "Spectrum.h"
+#include "Stats.h"
 #include <cmath>
 #include <iostream>
+#include <algorithm>
 
-Muon::Muon( Vector* x_0, double e, double theta_0, double phi_0, int anti) : Particle( anti*13, x_0, e, theta_0, phi_0 ) {
-    photons = new std::vector<Photon*>();
+Muon::Muon( const Vector& x_0, double e, double theta_0, double phi_0, int anti) : Particle( anti*13, x_0, e, theta_0, phi_0 ),
+n_cherenkov( 0 ), theta_c( 0 ), lambda_c( INFINITY ), spectrum( NULL ) {
+    
 }
 
-void Muon::Cherenkov( double n ) {
+void Muon::setRefractionIndex( double n ) {
+    
+    if( n == n_cherenkov ) return;
+    n_cherenkov = n;
     
     double v = this->getSpeed();
+    if( spectrum ) {
+        //the angle is computed for each photon with the index at its wavelength
+        theta_c  = 0;
+        lambda_c = spectrum->getLambdaC( v );
+        return;
+    }
+    if( v <= 1/n ) {
+        theta_c  = 0;
+        lambda_c = INFINITY;
+        return;
+    }
+    
+    theta_c  = acos( 1/v/n ); //Cherenkov angle
+    double k_prime  = 0.0010585;     //nm^-1 calculated with WolframAlpha
+    double efficiency_max = 0.2;
+    double k        = 2*M_PI*(1.0/137)*k_prime*efficiency_max; //nm^-1
+    lambda_c = 1/(k*sin(theta_c)*sin(theta_c))*0.0000001; //cm
+}
+
+void Muon::Cherenkov( double n ) {
+    
     Vector* x_0 = this->getLastPosition();
     
-    if(VERBOSE && v < 1/n) std::cout << "I can't do Cherenkov! " << std::endl;
+    setRefractionIndex( n );
+    if(VERBOSE && lambda_c == INFINITY) std::cout << "I can't do Cherenkov! " << std::endl;
     
-    if( v > 1/n ) {
+    if( lambda_c < INFINITY ) {
 
-        if(VERBOSE) std::cout << "I can do Cherenkov! "<< v << ">" << 1/n << std::endl;       
-        
-        double theta_0  = acos( 1/v/n ); //Cherenkov angle
-        double k_prime  = 0.0010585;     //nm^-1 calculated with WolframAlpha
-        double efficiency_max = 0.2;
-        double k        = 2*M_PI*(1.0/137)*k_prime*efficiency_max; //nm^-1
-        double lambda_c = 1/(k*sin(theta_0)*sin(theta_0))*0.0000001; //cm
-        double lambda   = 300*1000000; //fm photon wavelength
+        if(VERBOSE) std::cout << "I can do Cherenkov! "<< this->getSpeed() << ">" << 1/n << std::endl;       
         
         std::uniform_real_distribution<double> unif_dist(0,1);
         
         if( unif_dist(gen)<step_length/lambda_c ) {
-            Photon* ph = new Photon( new Vector(*x_0), 197.4/lambda, theta_0, 2*M_PI*unif_dist( gen ) );
-            photons->push_back( ph );
+            emitPhoton( *x_0 );
         } else if(VERBOSE) {
             std::cout << "No photons generated" << std::endl;
         }
@@ -39,6 +60,77 @@ void Muon::Cherenkov( double n ) {
     
 }
 
-std::vector<Photon*>* Muon::getPhotonList() {
-    return photons;
+void Muon::emitPhoton( const Vector& x_0 ) {
+    
+    std::uniform_real_distribution<double> unif_dist(0,1);
+    double theta_0 = theta_c;     //Cherenkov angle
+    double lambda  = 300*1000000; //fm photon wavelength
+    double n       = 0;           //index at the wavelength of the photon (0: the one of the setup)
+    if( spectrum ) {
+        //wavelength of a detected photon: the photons that the PM would not see are not created
+        double lambda_nm = spectrum->sample( this->getSpeed(), &n );
+        if( lambda_nm == 0 ) return;
+        theta_0 = acos( 1/this->getSpeed()/n );
+        lambda  = lambda_nm*1000000;
+    }
+    photons.emplace_back( x_0, 197.4/lambda, theta_0, 2*M_PI*unif_dist( gen ) );
+    if( n > 0 ) photons.back().setRefractionIndex( n );
+    STATS_COUNT( PHOTONS_GENERATED, 1 );
+}
+
+double Muon::getLambdaC( double n ) {
+    setRefractionIndex( n );
+    return lambda_c;
+}
+
+void Muon::setSpectrum( Spectrum* s ) {
+    spectrum    = s;
+    n_cherenkov = 0; //lambda_c is computed again
+}
+
+void Muon::CherenkovTrack( Setup* setup ) {
+    
+    //The muon goes straight through the radiator: the length of the chord is computed
+    //analytically, the number of photons is Poisson distributed with mean length/lambda_c
+    //and the emission points are uniformly distributed along the chord. Only the entry
+    //and the exit points of the muon are saved.
+    double n  = setup->getRefractionIndex();
+    double ux = dir_x;
+    double uy = dir_y;
+    double uz = dir_z;
+    
+    Wall   wall;
+    double length = 0;
+    if( setup->checkPosition( &x ) ) {
+        length = setup->distanceToWall( x.getX(), x.getY(), x.getZ(), ux, uy, uz, &wall );
+    }
+    
+    setRefractionIndex( n );
+    if( length > 0 && lambda_c < INFINITY ) {
+        
+        std::poisson_distribution<int>         poisson( length/lambda_c );
+        std::uniform_real_distribution<double> unif_dist(0,1);
+        
+        int nPhotons = poisson( gen );
+        photons.reserve( nPhotons );
+        std::vector<double> t( nPhotons );
+        for( int i = 0; i < nPhotons; i++ ) t[i] = length*unif_dist( gen );
+        std::sort( t.begin(), t.end() );
+        
+        for( int i = 0; i < nPhotons; i++ ) {
+            Vector x_0( x.getX() + t[i]*ux, x.getY() + t[i]*uy, x.getZ() + t[i]*uz );
+            emitPhoton( x_0 );
+        }
+        
+        if(VERBOSE) std::cout << "Length in the radiator: " << length << " cm, photons: " << nPhotons << std::endl;
+    }
+    
+    //exit point
+    this->nPos++;
+    x.shift( length*ux, length*uy, length*uz );
+    position.push_back( x );
+}
+
+std::vector<Photon>* Muon::getPhotonList() {
+    return &photons;
 }
@@ -4,15 +4,26 @@
 #include "Photon.h"
 #include <random>
 
+class Spectrum;
+
 class Muon: public Particle {
     
 public:
-    Muon( Vector* x_0, double e, double theta_0, double phi_0, int anti = 1 );
+    Muon( const Vector& x_0, double e, double theta_0, double phi_0, int anti = 1 );
     void Cherenkov( double n );
-    std::vector<Photon*>* getPhotonList();
+    void CherenkovTrack( Setup* setup ); //crosses the whole radiator at once
+    double getLambdaC( double n );      //cm mean distance between two Cherenkov photons
+    void   setSpectrum( Spectrum* s );  //emission of the detected photons only (NULL: one wavelength)
+    std::vector<Photon>* getPhotonList();
     
 private:
-    std::vector<Photon*>* photons;
+    void setRefractionIndex( double n ); //computes the Cherenkov angle and lambda_c only if n changes
+    void emitPhoton( const Vector& x_0 ); //a Cherenkov photon emitted in x_0
+    double n_cherenkov;                 //refraction index used for theta_c and lambda_c
+    double theta_c;                     //Cherenkov angle
+    double lambda_c;                    //cm mean distance between two Cherenkov photons
+    Spectrum* spectrum;                 //wavelength and refraction index of each photon, if not NULL
+    std::vector<Photon> photons; //the photons of the event, stored by value in one contiguous array
 };
 
 #endif
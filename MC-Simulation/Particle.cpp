@@ -6,11 +6,10 @@
 
 particles_data Particle::my_particles[30];
 
-Particle::Particle( int id, Vector* x_0, double e, double theta_0, double phi_0 ) :
+Particle::Particle( int id, const Vector& x_0, double e, double theta_0, double phi_0 ) :
 p_id( id ), x( x_0 ), energy( e ), theta( theta_0 ), phi( phi_0 ), nPos(0) {
     
-    position = new std::vector<Vector*>();
-    position->push_back( new Vector( x->getX(), x->getY(), x->getZ() ) );
+    position.push_back( x );
     
     particles_data data = Particle::my_particles[std::abs(p_id)];
     
@@ -19,6 +18,9 @@ p_id( id ), x( x_0 ), energy( e ), theta( theta_0 ), phi( phi_0 ), nPos(0) {
     step_length = data.step;
     p           = sqrt( energy*energy - mass*mass );
     v           = (mass == 0) ? 1.0/2 : p/energy; //TODO set massless particle speed to 1/n
+    dir_x       = sin(theta)*cos(phi);
+    dir_y       = sin(theta)*sin(phi);
+    dir_z       = cos(theta);
     
     if(VERBOSE){
         std::cout << std::endl;
@@ -32,7 +34,7 @@ p_id( id ), x( x_0 ), energy( e ), theta( theta_0 ), phi( phi_0 ), nPos(0) {
         std::cout << "  -> speed    : " << v << std::endl;
         std::cout << "  -> theta    : " << theta << std::endl;
         std::cout << "  -> phi      : " << phi << std::endl;
-        std::cout << "  -> initial position: (" << x->getX() << ", " << x->getY() << ", " << x->getZ() << ") " << std::endl;
+        std::cout << "  -> initial position: (" << x.getX() << ", " << x.getY() << ", " << x.getZ() << ") " << std::endl;
     }
     
 }
@@ -71,35 +73,35 @@ double Particle::getPhi() {
 
 void Particle::updatePosition() {
     this->nPos++;
-    x->shift( step_length*sin(theta)*cos(phi), step_length*sin(theta)*sin(phi), step_length*cos(theta) );
-    position->push_back( new Vector( x->getX(), x->getY(), x->getZ() ) );
-    if(VERBOSE) std::cout << "New muon position: (" << x->getX() << ", " << x->getY() << ", " << x->getZ() << ") " << std::endl;
+    x.shift( step_length*dir_x, step_length*dir_y, step_length*dir_z );
+    position.push_back( x );
+    if(VERBOSE) std::cout << "New muon position: (" << x.getX() << ", " << x.getY() << ", " << x.getZ() << ") " << std::endl;
 }
 
 void Particle::hitPM( double distance, double theta_prime, double phi_prime ) {
     this->nPos++;
-    x->shift( distance/cos(theta_prime)*sin(theta_prime)*cos(phi_prime), distance/cos(theta_prime)*sin(theta_prime)*sin(phi_prime), distance );
-    position->push_back( new Vector( x->getX(), x->getY(), x->getZ() ) );
+    x.shift( distance/cos(theta_prime)*sin(theta_prime)*cos(phi_prime), distance/cos(theta_prime)*sin(theta_prime)*sin(phi_prime), distance );
+    position.push_back( x );
 }
 
 Vector* Particle::getX() {
-    return x;
+    return &x;
 }
 
 Vector* Particle::getLastPosition() {
-    return position->back();
+    return &position.back();
 }
 
-std::vector<Vector*>* Particle::getPositionList() {
-    return position;
+std::vector<Vector>* Particle::getPositionList() {
+    return &position;
 }
 
-void Particle::setParticlesData() {
+void Particle::setParticlesData( Config* config ) {
     for(int i = 0; i < 30; i++) {
         Particle::my_particles[i] = particles_data();
     }
     //Here you can set mass (MeV), charge (e), step_length (cm) 0.006 cm PMMA 1.0 air/co2
-    Particle::my_particles[13] = particles_data( 105, -1, 0.006 );
-    Particle::my_particles[22] = particles_data( 0, 0, 0.1 );
+    Particle::my_particles[13] = particles_data( 105, -1, config->getDouble( "muon_step", 0.006 ) );
+    Particle::my_particles[22] = particles_data( 0, 0, config->getDouble( "photon_step", 0.1 ) );
 }
 
@@ -2,6 +2,7 @@
 #define Particle_h
 #include "Vector.h"
 #include "Setup.h"
+#include "Random.h"
 #include <vector>
 
 struct particles_data {
@@ -14,15 +15,12 @@ struct particles_data {
 
 static bool VERBOSE = 0;
 
-static std::random_device rd;
-static std::default_random_engine gen( rd() );
-
 class Particle {
 
 protected:
-    Particle( int id, Vector* x_0, double e, double theta_0, double phi_0 );
-    Vector* x;                      // position of the particle
-    std::vector<Vector*>* position; // vector containing all the positions
+    Particle( int id, const Vector& x_0, double e, double theta_0, double phi_0 );
+    Vector  x;                      // position of the particle
+    std::vector<Vector> position;   // all the positions, stored by value in one contiguous array
     double  step_length;            // cm propagation step
     int     p_id;                   // id of the particle
     double  mass;                   // mass of the particle
@@ -32,6 +30,9 @@ protected:
     double  v;                      // speed of the particle
     double  theta;                  // azimuthal angle of the particle' momentum
     double  phi;                    // angle on x,y plane of the particle' momentum
+    double  dir_x;                  // unit vector of the direction of motion: it is updated only
+    double  dir_y;                  // when the direction changes, so that the steps need no
+    double  dir_z;                  // trigonometric functions
     //std::mt19937 gen;
     //std::random_device rd;
     //std::default_random_engine gen;
@@ -50,10 +51,10 @@ public:
     void                  updatePosition();
     void                  hitPM( double distance, double theta_prime, double phi_prime ); 
     Vector*               getLastPosition();
-    std::vector<Vector*>* getPositionList();
+    std::vector<Vector>*  getPositionList();
     
     static particles_data my_particles[30];
-    static void setParticlesData();
+    static void setParticlesData( Config* config ); //the step lengths can be changed in the configuration
     
 };
 
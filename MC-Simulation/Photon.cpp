@@ -1,30 +1,72 @@
 #include "Photon.h"
+#include "Stats.h"
 #include <iostream>
+#include <cmath>
 
-Photon::Photon( Vector* x_0, double e, double theta_0, double phi_0, int anti ) : Particle( 22, x_0, e, theta_0, phi_0 ) {
+Photon::Photon( const Vector& x_0, double e, double theta_0, double phi_0, int anti ) : Particle( 22, x_0, e, theta_0, phi_0 ),
+nReflections( 0 ), weight( 1 ), killed( false ), n_photon( 0 ), cos_critical( 0 ), theta_ph_out( 0 ), phi_ph_out( 0 ), position_out( 0 ) {
     
 }
 
+bool Termination::keep( double cos_critical, double dir_z, int nReflections, double* weight ) const {
+    
+    //going up without total reflection, or trapped by total reflections on top/bottom
+    if( early && ( dir_z <= 0 || dir_z <= cos_critical ) ) return false;
+    
+    //Russian roulette on the long chains of reflections
+    if( reflections > 0 && nReflections >= reflections ) {
+        std::uniform_real_distribution<double> dist(0, 1);
+        if( dist(gen) >= survival ) return false;
+        *weight /= survival;
+    }
+    return true;
+}
+
+bool Photon::terminate( Setup* setup, const Termination* term ) {
+    
+    if( term == NULL || term->keep( getCosCritical( setup ), dir_z, nReflections, &weight ) ) return false;
+    kill();
+    return true;
+}
+
+void Photon::kill() {
+    
+    killed       = true;
+    position_out = 0;
+    theta_ph_out = acos( dir_z );
+    phi_ph_out   = atan2( dir_y, dir_x );
+    STATS_COUNT( PHOTONS_KILLED, 1 );
+    
+    if(VERBOSE) {
+        std::cout << "-> The photon cannot reach the PM plane: killed"<< std::endl;
+        printSummary();
+    }
+}
+
 void Photon::rotateProjections( double theta_1, double phi_1 ) {
     
     if (p_id == 22) { //not necessary
         
-        long double temp_x;
-        long double temp_y;
-        long double temp_z;
+        double temp_x = step_length*dir_x;
+        double temp_y = step_length*dir_y;
+        double temp_z = step_length*dir_z;
         
-        temp_x = step_length*sin(theta)*cos(phi);
-        temp_y = step_length*sin(theta)*sin(phi);
-        temp_z = step_length*cos(theta);
+        double cos_theta_1 = cos(theta_1), sin_theta_1 = sin(theta_1);
+        double cos_phi_1   = cos(phi_1),   sin_phi_1   = sin(phi_1);
         
         //Update the private variables: component of the shift in the global frame
         //This procedure could introduce an aproximation error.
-        proj_x = temp_x*cos(theta_1)*cos(phi_1) - temp_y*cos(theta_1)*sin(phi_1) + temp_z*sin(theta_1)*cos(phi_1);
-        proj_y = temp_x*cos(theta_1)*sin(phi_1) + temp_y*cos(theta_1)*cos(phi_1) + temp_z*sin(theta_1)*sin(phi_1);
-        proj_z = -temp_x*sin(theta_1) - temp_y*sin(theta_1) + temp_z*cos(theta_1);
+        proj_x = temp_x*cos_theta_1*cos_phi_1 - temp_y*cos_theta_1*sin_phi_1 + temp_z*sin_theta_1*cos_phi_1;
+        proj_y = temp_x*cos_theta_1*sin_phi_1 + temp_y*cos_theta_1*cos_phi_1 + temp_z*sin_theta_1*sin_phi_1;
+        proj_z = -temp_x*sin_theta_1 - temp_y*sin_theta_1 + temp_z*cos_theta_1;
         
         norm_proj = sqrt((proj_x*proj_x + proj_y*proj_y + proj_z*proj_z));
         
+        //direction in the global frame, used in all the steps
+        dir_x = proj_x/norm_proj;
+        dir_y = proj_y/norm_proj;
+        dir_z = proj_z/norm_proj;
+        
         if(VERBOSE) {
             std::cout << "-> The original step length was: " << step_length << std::endl;
             std::cout << "sum squares " << (proj_x*proj_x + proj_y*proj_y + proj_z*proj_z) << std::endl;
@@ -37,97 +79,128 @@ void Photon::rotateProjections( double theta_1, double phi_1 ) {
     
 }
 
-void Photon::updatePositionPh( double theta_1, double phi_1, Setup* setup ) {
+void Photon::updatePositionPh( Setup* setup ) {
+    if( setup->getGeometry() == CYLINDER ) updatePositionPh<Cylinder>( setup );
+    else                                   updatePositionPh<Box>( setup );
+}
+
+template<class G> void Photon::propagatePh( Setup* setup, const Termination* term ) {
+    while( !killed && setup->checkPosition<G>( &position.back() ) == true ) {
+        updatePositionPh<G>( setup, term );
+    }
+}
+
+template<class G> void Photon::updatePositionPh( Setup* setup, const Termination* term ) {
     this->nPos++;
+    STATS_COUNT( PHOTON_STEPS, 1 );
     //Shift the photon position of one step length and check whether the photon is inside or outside the box.
-    x->shift(proj_x, proj_y, proj_z); //these are the components of the shift in the global frame
+    x.shift(proj_x, proj_y, proj_z); //these are the components of the shift in the global frame
     
-    if ( setup->checkPosition(x) == true ) {
+    if ( setup->checkPosition<G>(&x) == true ) {
         
-        position->push_back( new Vector( x->getX(), x->getY(), x->getZ() ) );
+        position.push_back( x );
         
         if(VERBOSE) {
-            std::cout << "Is it still inside? "<< setup->checkPosition(x) << std::endl;
-            std::cout << "-> New photon position  : (" << x->getX() << ", " << x->getY() << ", " << x->getZ() << ")" << std::endl;
+            std::cout << "Is it still inside? "<< setup->checkPosition(&x) << std::endl;
+            std::cout << "-> New photon position  : (" << x.getX() << ", " << x.getY() << ", " << x.getZ() << ")" << std::endl;
             std::cout << "-> New shift projections: (" << proj_x << ", " << proj_y<< ", " << proj_z << ")" << std::endl;
             std::cout << "-> Norm projection      : " << norm_proj << std::endl;   
         }
         
-    } else if ( setup->checkPosition(x) == false ) {
+    } else if( nReflections >= maxReflections ) {
+        
+        //trapped by the total reflections: absorbed on the wall, as in tracePh
+        position.push_back( x );
+        position_out = 0;
+        theta_ph_out = acos( dir_z );
+        phi_ph_out   = atan2( dir_y, dir_x );
+        
+    } else {
 
         double ran = -1;
-        double reflection_angle = 0;
+        double cos_reflection = 1;
+        bool   lateral = false;
         
-        if(setup->getTypeOfDetector() == "c" ) {
+        if( G::lateralReflections ) {
+            //the lateral wall is crossed only if the photon is outside the radius of the cylinder
+            lateral = ( sqrt( x.getX()*x.getX() + x.getY()*x.getY() ) >= setup->getRadius() );
             std::uniform_real_distribution<double> dist(0, 1);
             ran = dist(gen); //generate random number for absorption/reflection on lateral walls
-            reflection_angle = getReflectionAngle(setup->getRadius());
+            cos_reflection = getReflectionCosine(setup->getRadius());
         
             if(VERBOSE) {
-                std::cout << "Is it still inside? "<< setup->checkPosition(x) << std::endl;
-                std::cout << "-> Photon position  : (" << x->getX() << ", " << x->getY() << ", " << x->getZ() << ")" << std::endl;
-                std::cout << "-> sin(theta)*n =" << setup->getRefractionIndex()*sin( acos( proj_z/norm_proj) ) << std::endl;
+                std::cout << "Is it still inside? "<< setup->checkPosition(&x) << std::endl;
+                std::cout << "-> Photon position  : (" << x.getX() << ", " << x.getY() << ", " << x.getZ() << ")" << std::endl;
+                std::cout << "-> sin(theta)*n =" << getRefractionIndex( setup )*sqrt( 1 - dir_z*dir_z ) << std::endl;
                 std::cout << "-> The random number is: " << ran << std::endl;
             }
         }
-        //REFLECTION ON TOP/BOTTOM
-        if( ( x->getZ() >= setup->getHeight() || x->getZ() <= 0.0 ) && 
-            setup->getRefractionIndex()*sin( acos( proj_z/norm_proj ) ) >= 1 ) { 
+        //REFLECTION ON TOP/BOTTOM: n*sin(theta) >= 1, with cos(theta) = |dir_z|
+        if( ( x.getZ() >= setup->getHeight() || x.getZ() <= 0.0 ) && 
+            totalReflection( setup, fabs( dir_z ) ) ) { 
             
             nReflections += 1;
+            STATS_COUNT( REFLECTIONS_TOP_BOTTOM, 1 );
             
             proj_z = -1.0*proj_z; //update only the z direction
+            dir_z  = -1.0*dir_z;
         
-            //x->shift(proj_x/2, proj_y/2, proj_z/2);
-            x->shift(proj_x, proj_y, proj_z);
-            position->push_back( new Vector( x->getX(), x->getY(), x->getZ() ) );
+            //x.shift(proj_x/2, proj_y/2, proj_z/2);
+            x.shift(proj_x, proj_y, proj_z);
+            position.push_back( x );
         
             if(VERBOSE) {
                     std::cout << "+++++++++++++Reflection on the bottom/top wall!+++++++++++++" << std::endl;
-                    std::cout << "-> New photon position  : (" << x->getX() << ", " << x->getY() << ", " << x->getZ() << ")" << std::endl;
+                    std::cout << "-> New photon position  : (" << x.getX() << ", " << x.getY() << ", " << x.getZ() << ")" << std::endl;
                     std::cout << "-> New shift projection : (" << proj_x << ", " << proj_y << ", " << proj_z << ")" << std::endl;
                     std::cout << "-> Norm projection      : " << norm_proj << std::endl;
                     std::cout << "-> Original step length : " << step_length << std::endl;
             }
         //TOTAL REFLECTION ON LATERAL WALLS       
-        } else if ( setup->getTypeOfDetector() == "c" && 
-                      reflection_angle >= setup->getCriticalAngle() && ran <= 0.5 ) {
+        } else if ( G::lateralReflections && lateral &&
+                      totalReflection( setup, cos_reflection ) && ran <= 0.5 ) {
             
             nReflections += 1;
+            STATS_COUNT( REFLECTIONS_LATERAL, 1 );
             //Remove the previous update in order to perform the reflection
-            x->shift(-proj_x, -proj_y, -proj_z);
+            x.shift(-proj_x, -proj_y, -proj_z);
             //Do reflection
             reflectionPhWall();
             //Update the position of the photon
-            position->push_back( new Vector( x->getX(), x->getY(), x->getZ() ) );
+            position.push_back( x );
             
             if(VERBOSE) {
                 std::cout << "-> The photons was reflected!" << std::endl;
-                std::cout << "-> New photon position  : (" << x->getX() << ", " << x->getY() << ", " << x->getZ() << ")" << std::endl;
+                std::cout << "-> New photon position  : (" << x.getX() << ", " << x.getY() << ", " << x.getZ() << ")" << std::endl;
                 std::cout << "-> New shift projections: (" << proj_x << ", " << proj_y<< ", " << proj_z << ")" << std::endl;
             }
+            //the reflection counts for the termination (dir_z does not change)
+            terminate( setup, term );
             
-        } else if ( setup->getTypeOfDetector() == "c" &&  ran > setup->ReflectionThreshold() ) { 
+        } else if ( G::lateralReflections && lateral && ran > setup->ReflectionThreshold() ) { 
 
             nReflections += 1;
+            STATS_COUNT( REFLECTIONS_LATERAL, 1 );
             //Remove the previous update in order to perform the reflection
-            x->shift(-proj_x, -proj_y, -proj_z);
+            x.shift(-proj_x, -proj_y, -proj_z);
             //Do reflection
             reflectionPhWall();
             //Update the position of the photon
-            position->push_back( new Vector( x->getX(), x->getY(), x->getZ() ) );
+            position.push_back( x );
             
             if(VERBOSE) {
                 std::cout << "-> The photons was reflected!" << std::endl;
-                std::cout << "-> New photon position  : (" << x->getX() << ", " << x->getY() << ", " << x->getZ() << ")" << std::endl;
+                std::cout << "-> New photon position  : (" << x.getX() << ", " << x.getY() << ", " << x.getZ() << ")" << std::endl;
                 std::cout << "-> New shift projections: (" << proj_x << ", " << proj_y<< ", " << proj_z << ")" << std::endl;
             }
+            //the reflection counts for the termination (dir_z does not change)
+            terminate( setup, term );
         
         } else { //reflection false
             
-            position->push_back( new Vector( x->getX(), x->getY(), x->getZ() ) );
+            position.push_back( x );
             //Determine the angles of the photon at the exit (useful to plot at the angular distribution);
-            theta_ph_out = acos( proj_z/norm_proj ); 
+            theta_ph_out = acos( dir_z ); 
             if( proj_y >=0 ) {
                 phi_ph_out = acos( proj_x/(sqrt(proj_x*proj_x+proj_y*proj_y)) );
             } else {
@@ -135,9 +208,9 @@ void Photon::updatePositionPh( double theta_1, double phi_1, Setup* setup ) {
             }
             //Check whether the photon exited from the bottom wall or not. 
             //Important to count the number of photons reaching the detector.
-            if ( x->getZ() >= setup->getHeight() ) {
+            if ( x.getZ() >= setup->getHeight() ) {
                 position_out = 1;
-            } else if (x->getZ() <= 0.0 ) {
+            } else if (x.getZ() <= 0.0 ) {
                 position_out = -1; 
             } else {
                 position_out = 0;
@@ -152,16 +225,14 @@ void Photon::updatePositionPh( double theta_1, double phi_1, Setup* setup ) {
     }
 }
 
-double Photon::getReflectionAngle( double r ) { //input: the radius of the cylinder taken from setup
+double Photon::getReflectionCosine( double r ) { //input: the radius of the cylinder taken from setup
     
-    double x0 = x->getX();
-    double y0 = x->getY();
-    double z0 = x->getZ();
+    double x0 = x.getX();
+    double y0 = x.getY();
     
     //I take this point as an approximation of the intersection point.
     double x1 = x0 + proj_x/2;
     double y1 = y0 + proj_y/2;
-    double z1 = z0 + proj_z/2;
     
     if(VERBOSE) {
         std::cout << "-> Step length: " << step_length << std::endl;
@@ -170,37 +241,37 @@ double Photon::getReflectionAngle( double r ) { //input: the radius of the cylin
     
     //The three components of the versor u of the shift in order: 
     //necessary to computer the reflection angles.
-    double vers_shift_x = proj_x/norm_proj; //I could use also step length
-    double vers_shift_y = proj_y/norm_proj;
-    double vers_shift_z = proj_z/norm_proj;
+    double vers_shift_x = dir_x;
+    double vers_shift_y = dir_y;
 
     
     //Compute the angle between the normal to the plane and the versor of the shift as the internal product between them. The normal to the plan is always the radius. Compute the versor of the radius. The coordinates of the radius are those of the intersection point.
     
-    vers_r_x = x1/r;//this is cos of the angle between the radius and the x-axes
-    vers_r_y = y1/r;//this is cos of the angle between the radius and the y-axes
+    //The point is not exactly on the wall, so the radius is normalized with its own length.
+    double r1 = sqrt(x1*x1 + y1*y1);
+    vers_r_x = x1/r1;//this is cos of the angle between the radius and the x-axes
+    vers_r_y = y1/r1;//this is cos of the angle between the radius and the y-axes
     vers_r_z = 0;
     
     
     cos_theta_0 = (vers_r_x*vers_shift_x) + (vers_r_y*vers_shift_y);//Derived by means of tringonometry
-    cos_phi_0   = sqrt(1 - cos_theta_0*cos_theta_0);
     
-    return acos(cos_theta_0);
+    return cos_theta_0;
 }
 
 
 void Photon::reflectionPhWall() {
 
-        //Find the component of the shift w.r. to the plan and it's normal vector.
-        double shift_normal = step_length* cos_theta_0;
-        double shift_plan   = step_length * cos_phi_0 ; //è la y
-        
+        //Mirror reflection: the component of the shift along the normal to the wall changes sign,
+        //the component along the wall and proj_z do not change, and so neither does the step length.
+        double shift_normal = proj_x*vers_r_x + proj_y*vers_r_y;
         
-        //Find the new component of the shift versor after the reflection (w.r. to the g.f.)
-        proj_x = shift_normal*(-1.0*vers_r_x) - shift_plan*vers_r_y;
-        proj_y  = -1.0*shift_normal*vers_r_y + shift_plan*vers_r_x;
+        proj_x -= 2*shift_normal*vers_r_x;
+        proj_y -= 2*shift_normal*vers_r_y;
         
-        norm_proj =  sqrt((proj_x*proj_x + proj_y*proj_y + proj_z*proj_z));
+        dir_x = proj_x/norm_proj;
+        dir_y = proj_y/norm_proj;
+        dir_z = proj_z/norm_proj;
         
         if(VERBOSE) {
             std::cout << "+++++++++++++Reflection on the lateral wall!++++++++++++++++++" << std::endl;
@@ -210,12 +281,104 @@ void Photon::reflectionPhWall() {
         }
 }
 
+void Photon::tracePh( Setup* setup ) {
+    if( setup->getGeometry() == CYLINDER ) tracePh<Cylinder>( setup );
+    else                                   tracePh<Box>( setup );
+}
+
+template<class G> void Photon::tracePh( Setup* setup, const Termination* term ) {
+    
+    //Instead of moving by steps, the photon goes straight to the next wall (computed in
+    //Setup::distanceToWall). There the same rules of updatePositionPh are applied, but the
+    //reflection angle is computed in the exact hit point and the reflection is a mirror
+    //reflection, so the photon does not depend on the step length.
+    double r  = setup->getRadius();
+    double ux = dir_x;
+    double uy = dir_y;
+    double uz = dir_z;
+    
+    if( setup->checkPosition<G>( &x ) == false ) return;
+    
+    while( true ) {
+        
+        Wall   wall;
+        double t = setup->distanceToWall<G>( x.getX(), x.getY(), x.getZ(), ux, uy, uz, &wall );
+        
+        this->nPos++;
+        STATS_COUNT( PHOTON_STEPS, 1 );
+        x.shift( t*ux, t*uy, t*uz );
+        position.push_back( x );
+        
+        if( nReflections >= maxReflections ) {
+            position_out = 0;
+            break;
+        }
+        
+        //REFLECTION ON TOP/BOTTOM
+        if( wall != LATERAL && totalReflection( setup, fabs( uz ) ) ) {
+            nReflections += 1;
+            STATS_COUNT( REFLECTIONS_TOP_BOTTOM, 1 );
+            uz = -1.0*uz;
+            continue;
+        }
+        
+        //REFLECTION ON LATERAL WALLS
+        if( wall == LATERAL && G::lateralReflections ) {
+            std::uniform_real_distribution<double> dist(0, 1);
+            double ran = dist(gen);
+            
+            //the normal to the wall is the radius in the hit point
+            vers_r_x = x.getX()/r;
+            vers_r_y = x.getY()/r;
+            vers_r_z = 0;
+            cos_theta_0 = vers_r_x*ux + vers_r_y*uy;
+            
+            if( ( totalReflection( setup, cos_theta_0 ) && ran <= 0.5 ) || ran > setup->ReflectionThreshold() ) {
+                nReflections += 1;
+                STATS_COUNT( REFLECTIONS_LATERAL, 1 );
+                ux -= 2*cos_theta_0*vers_r_x;
+                uy -= 2*cos_theta_0*vers_r_y;
+                if( term && !term->keep( getCosCritical( setup ), uz, nReflections, &weight ) ) {
+                    kill();
+                    break;
+                }
+                continue;
+            }
+        }
+        
+        //The photon goes out
+        if( wall == BOTTOM ) {
+            position_out = 1;
+        } else if( wall == TOP ) {
+            position_out = -1;
+        } else {
+            position_out = 0;
+        }
+        break;
+    }
+    
+    dir_x  = ux;
+    dir_y  = uy;
+    dir_z  = uz;
+    proj_x = ux*norm_proj;
+    proj_y = uy*norm_proj;
+    proj_z = uz*norm_proj;
+    theta_ph_out = acos( uz );
+    phi_ph_out   = atan2( uy, ux );
+    
+    if(VERBOSE) {
+        std::cout << "-> The photon is out of the box!"<< std::endl;
+        std::cout << "-> Position out: " << position_out << std::endl;
+        printSummary();
+    }
+}
+
 void Photon::printSummary() {
     
     std::cout << "**********INFORMATION************" << std::endl;
     std::cout << "-> Theta_ph_out " << theta_ph_out << std::endl;
     std::cout << "-> Phi_ph_out "   << phi_ph_out   << std::endl;
-    std::cout << "-> New photon position: (" << x->getX() << ", " << x->getY() << ", " << x->getZ() << ")" << std::endl;
+    std::cout << "-> New photon position: (" << x.getX() << ", " << x.getY() << ", " << x.getZ() << ")" << std::endl;
     std::cout << "-> Number of reflections: " << nReflections << std::endl;
     std::cout << "*********************************" << std::endl;
 
@@ -238,3 +401,31 @@ int Photon::getnReflections() {
     return nReflections;
 }
 
+void Photon::setRefractionIndex( double n ) {
+    n_photon     = n;
+    cos_critical = sqrt( 1 - 1/n/n );
+}
+
+double Photon::getRefractionIndex( Setup* setup ) {
+    return ( n_photon > 0 ) ? n_photon : setup->getRefractionIndex();
+}
+
+double Photon::getCosCritical( Setup* setup ) {
+    return ( n_photon > 0 ) ? cos_critical : setup->getCosCriticalAngle();
+}
+
+bool Photon::isKilled() {
+    return killed;
+}
+
+double Photon::getWeight() {
+    return weight;
+}
+
+//Instantiation of the transport for each shape of the radiator
+template void Photon::updatePositionPh<Cylinder>( Setup* setup, const Termination* term );
+template void Photon::updatePositionPh<Box>( Setup* setup, const Termination* term );
+template void Photon::propagatePh<Cylinder>( Setup* setup, const Termination* term );
+template void Photon::propagatePh<Box>( Setup* setup, const Termination* term );
+template void Photon::tracePh<Cylinder>( Setup* setup, const Termination* term );
+template void Photon::tracePh<Box>( Setup* setup, const Termination* term );
@@ -2,29 +2,73 @@
 #define Photon_h
 #include "Particle.h"
 
+//Termination of the photons that cannot reach the PM plane (--termination, --roulette_reflections).
+//The lateral walls do not change the sign of the z direction and do not make a photon leave the
+//total reflection on top/bottom: a photon going up without total reflection goes out from the top
+//and a photon with total reflection on top/bottom is trapped until a lateral wall absorbs it, so
+//only the photons going down without total reflection are transported. After 'reflections'
+//reflections, counted on all the faces (nReflections of the photon), the photon plays the Russian
+//roulette at each reflection on the lateral walls: it is killed with probability 1 - survival,
+//otherwise its weight is divided by survival, so that the sum of the weights on the PM plane is unbiased.
+struct Termination {
+    Termination() : early( false ), reflections( 0 ), survival( 1 ) {};
+    bool   early;       //kills the photons as soon as they cannot reach the PM plane
+    int    reflections; //reflections on all the faces before the roulette, 0: no roulette
+    double survival;    //probability to survive each roulette
+    //true if the photon with direction dir_z and nReflections reflections goes on (its weight can change);
+    //cos_critical is the cosine of the critical angle for the refraction index of the photon
+    bool   keep( double cos_critical, double dir_z, int nReflections, double* weight ) const;
+};
+
 class Photon: public Particle {
 
+    friend class PhotonBatch;
+    friend class AcceptanceTable;
+
 public:
-    Photon( Vector* x_0, double e, double theta_0, double phi_0, int anti = 1 );
+    Photon( const Vector& x_0, double e, double theta_0, double phi_0, int anti = 1 );
     
     int    getnReflections();
     double getThetaOut_ph();
     double getPhiOut_ph();
-    double getReflectionAngle(double r);
-    void   updatePositionPh( double theta_1, double phi_1, Setup* setup );
+    double getReflectionCosine(double r); //cosine of the angle with the normal to the lateral wall
+    void   updatePositionPh( Setup* setup ); //one step of the photon
+    void   tracePh( Setup* setup ); //moves the photon from wall to wall until it leaves the radiator
+    //Versions for a given shape G of the radiator (see Geometry.h); with term the photon can be
+    //killed before it leaves the radiator (see Termination)
+    template<class G> void updatePositionPh( Setup* setup, const Termination* term = NULL );
+    template<class G> void propagatePh( Setup* setup, const Termination* term = NULL ); //moves the photon step by step until it leaves the radiator
+    template<class G> void tracePh( Setup* setup, const Termination* term = NULL );
+    bool   terminate( Setup* setup, const Termination* term ); //true if the photon is killed
+    bool   isKilled();
+    double getWeight();
+    void   setRefractionIndex( double n );     //index of the radiator at the wavelength of the photon (--emission spectrum)
+    double getRefractionIndex( Setup* setup ); //that of setup if it was not set
+    //total reflection for the cosine of the angle with the normal to the wall, with the index of the photon
+    bool   totalReflection( Setup* setup, double cos_incidence ) {
+        return ( n_photon > 0 ) ? ( cos_incidence <= cos_critical ) : setup->totalReflection( cos_incidence );
+    };
+    double getCosCritical( Setup* setup ); //cosine of the critical angle, with the index of the photon
     void   rotateProjections(double theta_1, double phi_1);
-    void   reflectionPhWall(); //returns the reflected position
+    void   reflectionPhWall(); //mirror reflection of the step on the lateral wall (after getReflectionCosine)
     void   printSummary();
     int    getPosition_out();
     
+    //a photon trapped by total reflections is absorbed on the wall after maxReflections (all the transports)
+    static const int maxReflections = 10000;
+    
 private:
-    int    nReflections; //number of reflections on the side walls
+    void   kill();
+    int    nReflections; //number of reflections on all the faces (top/bottom and lateral walls)
+    double weight      ; //weight of the photon, changed by the Russian roulette
+    bool   killed      ; //killed by the termination: it does not reach the PM plane
+    double n_photon    ; //refraction index at the wavelength of the photon, 0: that of setup
+    double cos_critical; //cosine of the critical angle for n_photon
     double proj_x      ; //x projection of the step_length
     double proj_y      ; //y projection of the step_length
     double proj_z      ; //z projeciton of the step_length
     double norm_proj   ; //norm of the shift
     double cos_theta_0 ;
-    double cos_phi_0   ;
     double vers_r_x    ;
     double vers_r_y    ;
     double vers_r_z    ;
@@ -0,0 +1,234 @@
+#include "PhotonBatch.h"
+#include "Stats.h"
+#include <cmath>
+
+PhotonBatch::PhotonBatch() : nActive( 0 ) {
+    
+}
+
+void PhotonBatch::add( Photon* ph ) {
+    photons.push_back( ph );
+    x.push_back( ph->x.getX() );
+    y.push_back( ph->x.getY() );
+    z.push_back( ph->x.getZ() );
+    proj_x.push_back( ph->proj_x );
+    proj_y.push_back( ph->proj_y );
+    proj_z.push_back( ph->proj_z );
+    norm_proj.push_back( ph->norm_proj );
+    nReflections.push_back( ph->nReflections );
+    inside.push_back( 1 );
+    done.push_back( 0 );
+    nActive++;
+}
+
+void PhotonBatch::clear() {
+    photons.clear();
+    x.clear();
+    y.clear();
+    z.clear();
+    proj_x.clear();
+    proj_y.clear();
+    proj_z.clear();
+    norm_proj.clear();
+    nReflections.clear();
+    inside.clear();
+    done.clear();
+    nActive = 0;
+}
+
+int PhotonBatch::getSize() {
+    return photons.size();
+}
+
+//The step is in a function with __restrict parameters: with the pointers taken from the
+//vectors inside the method the compiler has to check the aliasing of the six arrays at run
+//time, and it does not vectorize the loop.
+static void stepArrays( int n, double* __restrict px, double* __restrict py, double* __restrict pz,
+                        const double* __restrict ppx, const double* __restrict ppy, const double* __restrict ppz ) {
+    
+    for( int i = 0; i < n; i++ ) {
+        px[i] += ppx[i];
+        py[i] += ppy[i];
+        pz[i] += ppz[i];
+    }
+}
+
+void PhotonBatch::step( int n ) {
+    stepArrays( n, x.data(), y.data(), z.data(), proj_x.data(), proj_y.data(), proj_z.data() );
+}
+
+template<class G> void PhotonBatch::markInside( int n, double r, double h ) {
+    
+    double* __restrict px = x.data();
+    double* __restrict py = y.data();
+    double* __restrict pz = z.data();
+    char*   __restrict in = inside.data();
+    
+    for( int i = 0; i < n; i++ ) {
+        in[i] = G::inside( px[i], py[i], pz[i], r, h );
+    }
+}
+
+void PhotonBatch::propagate( Setup* setup ) {
+    if( setup->getGeometry() == CYLINDER ) propagate<Cylinder>( setup );
+    else                                   propagate<Box>( setup );
+}
+
+template<class G> void PhotonBatch::propagate( Setup* setup, const Termination* term ) {
+    
+    double r = setup->getRadius();
+    double h = setup->getHeight();
+    
+    //photons created outside the radiator are not propagated
+    markInside<G>( nActive, r, h );
+    for( int i = nActive-1; i >= 0; i-- ) {
+        if( !inside[i] ) remove( i );
+    }
+    
+    while( nActive > 0 ) {
+        
+        //Step of all the photons: step and markInside are vectorized
+        step( nActive );
+        markInside<G>( nActive, r, h );
+        STATS_COUNT( PHOTON_STEPS, nActive );
+        
+        //Save the new positions and handle the photons that crossed a wall
+        for( int i = 0; i < nActive; i++ ) {
+            Photon* ph = photons[i];
+            ph->nPos++;
+            if( inside[i] ) {
+                ph->position.push_back( Vector( x[i], y[i], z[i] ) );
+            } else {
+                crossWall<G>( i, setup, term );
+            }
+        }
+        
+        //Remove the photons that have left the radiator
+        for( int i = nActive-1; i >= 0; i-- ) {
+            if( done[i] ) remove( i );
+        }
+    }
+}
+
+template<class G> void PhotonBatch::crossWall( int i, Setup* setup, const Termination* term ) {
+    
+    Photon* ph = photons[i];
+    double  r  = setup->getRadius();
+    double  h  = setup->getHeight();
+    
+    double ran = -1;
+    double cos_reflection = 1;
+    double vers_r_x = 0, vers_r_y = 0, cos_theta_0 = 0;
+    bool   lateral = false;
+    
+    //trapped by the total reflections: absorbed on the wall, as in Photon::tracePh
+    if( nReflections[i] >= Photon::maxReflections ) {
+        ph->position.push_back( Vector( x[i], y[i], z[i] ) );
+        ph->theta_ph_out = acos( proj_z[i]/norm_proj[i] );
+        ph->phi_ph_out   = atan2( proj_y[i], proj_x[i] );
+        ph->position_out = 0;
+        done[i] = 1;
+        return;
+    }
+    
+    if( G::lateralReflections ) {
+        lateral = ( sqrt( x[i]*x[i] + y[i]*y[i] ) >= r );
+        std::uniform_real_distribution<double> dist(0, 1);
+        ran = dist(gen);
+        //cosine of the angle with the normal to the wall, computed as in Photon::getReflectionCosine
+        double x1 = x[i] + proj_x[i]/2;
+        double y1 = y[i] + proj_y[i]/2;
+        double r1 = sqrt( x1*x1 + y1*y1 );
+        vers_r_x = x1/r1;
+        vers_r_y = y1/r1;
+        cos_theta_0 = vers_r_x*proj_x[i]/norm_proj[i] + vers_r_y*proj_y[i]/norm_proj[i];
+        cos_reflection = cos_theta_0;
+    }
+    
+    //REFLECTION ON TOP/BOTTOM: n*sin(theta) >= 1
+    double cos_z = proj_z[i]/norm_proj[i];
+    if( ( z[i] >= h || z[i] <= 0.0 ) && ph->totalReflection( setup, fabs( cos_z ) ) ) {
+        
+        nReflections[i] += 1;
+        STATS_COUNT( REFLECTIONS_TOP_BOTTOM, 1 );
+        proj_z[i] = -1.0*proj_z[i];
+        x[i] += proj_x[i];
+        y[i] += proj_y[i];
+        z[i] += proj_z[i];
+        ph->position.push_back( Vector( x[i], y[i], z[i] ) );
+        
+        if( !G::inside( x[i], y[i], z[i], r, h ) ) done[i] = 1;
+        
+    //REFLECTION ON LATERAL WALLS
+    } else if( G::lateralReflections && lateral && ( ( ph->totalReflection( setup, cos_reflection ) && ran <= 0.5 ) || 
+                                          ran > setup->ReflectionThreshold() ) ) {
+        
+        nReflections[i] += 1;
+        STATS_COUNT( REFLECTIONS_LATERAL, 1 );
+        //back to the previous position, then reflection as in Photon::reflectionPhWall
+        x[i] -= proj_x[i];
+        y[i] -= proj_y[i];
+        z[i] -= proj_z[i];
+        double shift_normal = cos_theta_0*norm_proj[i];
+        proj_x[i] -= 2*shift_normal*vers_r_x;
+        proj_y[i] -= 2*shift_normal*vers_r_y;
+        ph->position.push_back( Vector( x[i], y[i], z[i] ) );
+        
+        //the reflection counts for the termination (the z direction does not change)
+        if( term && !term->keep( ph->getCosCritical( setup ), proj_z[i]/norm_proj[i], nReflections[i], &ph->weight ) ) {
+            ph->dir_x = proj_x[i]/norm_proj[i];
+            ph->dir_y = proj_y[i]/norm_proj[i];
+            ph->dir_z = proj_z[i]/norm_proj[i];
+            ph->kill();
+            done[i] = 1;
+        }
+        
+    } else { //the photon goes out
+        
+        ph->position.push_back( Vector( x[i], y[i], z[i] ) );
+        ph->theta_ph_out = acos( cos_z );
+        double phi = acos( proj_x[i]/sqrt( proj_x[i]*proj_x[i] + proj_y[i]*proj_y[i] ) );
+        ph->phi_ph_out = ( proj_y[i] >= 0 ) ? phi : -phi;
+        if( z[i] >= h ) {
+            ph->position_out = 1;
+        } else if( z[i] <= 0.0 ) {
+            ph->position_out = -1;
+        } else {
+            ph->position_out = 0;
+        }
+        done[i] = 1;
+    }
+}
+
+void PhotonBatch::remove( int i ) {
+    
+    //copy the final state back to the photon
+    Photon* ph = photons[i];
+    ph->x = Vector( x[i], y[i], z[i] );
+    ph->proj_x = proj_x[i];
+    ph->proj_y = proj_y[i];
+    ph->proj_z = proj_z[i];
+    ph->norm_proj = norm_proj[i];
+    ph->dir_x = proj_x[i]/norm_proj[i];
+    ph->dir_y = proj_y[i]/norm_proj[i];
+    ph->dir_z = proj_z[i]/norm_proj[i];
+    ph->nReflections = nReflections[i];
+    
+    int last = nActive-1;
+    photons[i]      = photons[last];
+    x[i]            = x[last];
+    y[i]            = y[last];
+    z[i]            = z[last];
+    proj_x[i]       = proj_x[last];
+    proj_y[i]       = proj_y[last];
+    proj_z[i]       = proj_z[last];
+    norm_proj[i]    = norm_proj[last];
+    nReflections[i] = nReflections[last];
+    inside[i]       = inside[last];
+    done[i]         = done[last];
+    nActive--;
+}
+
+//Instantiation of the transport for each shape of the radiator
+template void PhotonBatch::propagate<Cylinder>( Setup* setup, const Termination* term );
+template void PhotonBatch::propagate<Box>( Setup* setup, const Termination* term );
@@ -0,0 +1,46 @@
+#ifndef PhotonBatch_h
+#define PhotonBatch_h
+#include "Photon.h"
+#include "Setup.h"
+#include <vector>
+
+//Transport engine that moves all the photons of an event together. The state of the
+//photons is kept in contiguous arrays (structure of arrays): the step and the check of
+//the position are done for all the photons in the same loop, which the compiler turns 
+//into vector instructions. Only the photons that crossed a wall are then handled one 
+//by one, with the same rules of Photon::updatePositionPh: the reflections are not
+//vectorized. At each step only a few photons cross a wall, and a masked loop on copies
+//of their arrays was slower than the scalar code.
+class PhotonBatch {
+
+public:
+    PhotonBatch();
+    void add( Photon* ph );              //to be called after Photon::rotateProjections
+    void propagate( Setup* setup );      //moves the photons until they leave the radiator
+    //version for a given shape G (see Geometry.h); with term the photons can be killed before (see Termination)
+    template<class G> void propagate( Setup* setup, const Termination* term = NULL );
+    void clear();
+    int  getSize();
+    
+private:
+    void step( int n );                  //one step of the first n photons
+    template<class G> void markInside( int n, double r, double h );
+    template<class G> void crossWall( int i, Setup* setup, const Termination* term );
+    void remove( int i );                //the photon i has finished: the last one takes its place
+    
+    std::vector<Photon*> photons;
+    std::vector<double>  x;              //position
+    std::vector<double>  y;
+    std::vector<double>  z;
+    std::vector<double>  proj_x;         //shift at each step
+    std::vector<double>  proj_y;
+    std::vector<double>  proj_z;
+    std::vector<double>  norm_proj;
+    std::vector<int>     nReflections;
+    std::vector<char>    inside;         //1 if the photon is still inside after the last step
+    std::vector<char>    done;           //1 if the photon has left the radiator
+    int                  nActive;
+    
+};
+
+#endif
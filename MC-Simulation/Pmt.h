@@ -0,0 +1,31 @@
+#ifndef Pmt_h
+#define Pmt_h
+#include <cmath>
+
+//Anode grid of the Hamamatsu H8500 on the PM plane: 8x8 pixels with a pitch of 0.608 cm,
+//centred on the axis of the radiator. The channels are numbered as in the data (see
+//Data-Analysis/Reader.C): channel = 8*row + 8-column, with row (along y) and column
+//(along x) from 0 to 7, so that the channels go from 1 to 64.
+const int    nPixels    = 64;
+const double pixelPitch = 0.608; //cm
+
+//Channels read out in the test beam, in the order of the branches of the data
+const int nChannelsPmt = 26;
+const int activeChannels[nChannelsPmt] = {21,22,29,30,37,38,45,46,5,6,13,14,53,54,61,62,40,39,32,31,24,23,16,15,7,8};
+
+//Channel of the pixel hit in (x,y), 0 outside the Pmt
+inline int pmtChannel( double x, double y ) {
+    int column = (int)floor( x/pixelPitch ) + 4;
+    int row    = (int)floor( y/pixelPitch ) + 4;
+    if( column < 0 || column > 7 || row < 0 || row > 7 ) return 0;
+    return 8*row + 8-column;
+}
+
+//Digitizer of the i-th active channel
+inline int pmtDigitizer( int i ) {
+    if( i < 8 )  return 20;
+    if( i < 24 ) return 31;
+    return 25;
+}
+
+#endif
@@ -0,0 +1,14 @@
+#include "Random.h"
+
+thread_local std::mt19937_64 gen;
+
+void seedEvent( unsigned long seed, long event ) {
+    std::seed_seq seq{ (unsigned int)( seed & 0xffffffff ), (unsigned int)( seed >> 32 ),
+                       (unsigned int)( event & 0xffffffff ), (unsigned int)( (unsigned long)event >> 32 ) };
+    gen.seed( seq );
+}
+
+unsigned long generateSeed() {
+    std::random_device rd;
+    return ( (unsigned long)rd() << 32 ) | rd();
+}
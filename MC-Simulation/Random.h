@@ -0,0 +1,13 @@
+#ifndef Random_h
+#define Random_h
+#include <random>
+
+//Random engine of the calling thread. It is reseeded at the beginning of every event
+//with a stream derived from the master seed and the event number: in this way the
+//result of an event does not depend on the thread that simulates it.
+extern thread_local std::mt19937_64 gen;
+
+void          seedEvent( unsigned long seed, long event );
+unsigned long generateSeed();
+
+#endif
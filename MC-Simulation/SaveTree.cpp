@@ -1,114 +1,218 @@
 #include <vector>
 #include <iostream>
-#include "Muon.h"
+#include "SaveTree.h"
+#include "Photon.h"
 #include "Vector.h"
+#include "Stats.h"
 #include "TFile.h"
 #include "TTree.h"
-#include <stdio.h>
+#include <cmath>
 
-static void SaveTree( std::vector<Muon*>* muList, int maxPos ) {
-    
-    std::cout << "* Saving events!" << std::endl;
-    
-    int nEvents = muList->size();
-    
-    TFile *file = new TFile( "./output/Cherenkov_MC.root", "RECREATE" );
-    TTree *tree = new TTree( "Cherenkov", "Cherenkov" );
-    
-    //const int length = 10000;
-    int length = maxPos;
-    TString xstring = Form("x[%i]/D",maxPos);
-    TString ystring = Form("y[%i]/D",maxPos);
-    TString zstring = Form("z[%i]/D",maxPos);
-    
-    int evNumber;       tree->Branch( "evNumber",     &evNumber,     "evNumber/I"    );
-    int id;             tree->Branch( "id",           &id,           "id/I"          );
-    double energy;      tree->Branch( "energy",       &energy,       "energy/D"      );
-    double x[maxPos];   tree->Branch( "x",             x,             xstring);
-    double y[maxPos];   tree->Branch( "y",             y,             ystring  ); 
-    double z[maxPos];   tree->Branch( "z",             z,             zstring );
-    double theta_out;   tree->Branch( "theta_out",    &theta_out,    "theta_out/D"   );
-    double phi_out;     tree->Branch( "phi_out",      &phi_out,      "phi_out/D"     );
-    int position_out;   tree->Branch( "position_out", &position_out, "position_out/I");
-    double x_PM;        tree->Branch( "x_PM",         &x_PM,         "x_PM/D"       );
-    double y_PM;        tree->Branch( "y_PM",         &y_PM,         "y_PM/D"       );
-    double z_PM;        tree->Branch( "z_PM",         &z_PM,         "z_PM/D"       );
-    int phNumber;       tree->Branch( "phNumber",     &phNumber,     "phNumber/I"    );
-    
-    for( int i=0; i<nEvents; i++ ) {
-        
-        if(i%5==0) std::cout << "* ..." << int(i*1.0/nEvents*100) << "\% completed" << std::endl;
-        
-        evNumber = i+1;
+//Geometry of the test beam in the reference frame of the data (Data-Analysis/Reader.C): z goes
+//down from the upper Si layer, the top of the radiator is at zRadiator and its axis at (x,y) = center
+static const double z_xSi[2]       = { 9.00, 21.05 };
+static const double z_ySi[2]       = { 10.5, 19.55 };
+static const double zTopRadiator   = 41.55;
+static const double xcenterRadiator = 4.96292;
+static const double ycenterRadiator = 3.97302;
+
+SaveTree::SaveTree( std::string file_name, bool hits_only ) : hits_only( hits_only ), index( NULL ), x( 1000 ), y( 1000 ), z( 1000 ) {
+    
+    file = new TFile( file_name.c_str(), "RECREATE" );
+    tree = new TTree( "Cherenkov", "Cherenkov" );
+    //write the baskets and the tree header every ~10 MB: a crash loses only the last part of the run
+    tree->SetAutoFlush( -10000000 );
+    tree->SetAutoSave( -10000000 );
+    
+    if( hits_only ) {
+        //one entry per event: the entry of the event evNumber is evNumber-1, no EventIndex is needed
+        tree->Branch( "evNumber",       &evNumber,      "evNumber/I"           );
+        tree->Branch( "xHit",           xHit,           "xHit[2]/D"            );
+        tree->Branch( "yHit",           yHit,           "yHit[2]/D"            );
+        tree->Branch( "z_xHit",         z_xHit,         "z_xHit[2]/D"          );
+        tree->Branch( "z_yHit",         z_yHit,         "z_yHit[2]/D"          );
+        tree->Branch( "phi",            &phi_mu,        "phi/D"                );
+        tree->Branch( "theta",          &theta_mu,      "theta/D"              );
+        tree->Branch( "DgtzID",         DgtzID,         "DgtzID[26]/I"         );
+        tree->Branch( "PmtChannelID",   PmtChannelID,   "PmtChannelID[26]/I"   );
+        tree->Branch( "PmtPulseHeight", PmtPulseHeight, "PmtPulseHeight[26]/D" );
+        tree->Branch( "PmtTime",        PmtTime,        "PmtTime[26]/D"        );
+        tree->Branch( "xRadiator",      &xRadiator,     "xRadiator/D"          );
+        tree->Branch( "yRadiator",      &yRadiator,     "yRadiator/D"          );
+        tree->Branch( "zRadiator",      &zRadiator,     "zRadiator/D"          );
+        tree->Branch( "TrgUp",          &TrgUp,         "TrgUp/D"              );
+        tree->Branch( "TrgDown",        &TrgDown,       "TrgDown/D"            );
+        tree->Branch( "Dinode",         &Dinode,        "Dinode/D"             );
+        tree->Branch( "PmtPixelCounts", PmtPixelCounts, "PmtPixelCounts[64]/I" );
         
-        //set all coordinates to (0,0,0)
-        for( int j = 0; j < length; j++ ) {
-            x[j] = y[j] = z[j] = -999;
+        //the part of the event which does not change
+        for( int i = 0; i < nChannelsPmt; i++ ) {
+            DgtzID[i]       = pmtDigitizer( i );
+            PmtChannelID[i] = activeChannels[i];
+            PmtTime[i]      = ( DgtzID[i] == 31 ) ? 210 : 100; //middle of the time window of the digitizer
         }
-        
-        Muon* mu = muList->at( i );
-        
-        id = 13;
-        energy = muList->at( i )->getEnergy();
-        
-        //loop on muon positions
-        int nPos = mu->getPositionList()->size();
-        
-        for( int j = 0; j < nPos; j++ ) {
-            Vector* x_mu = mu->getPositionList()->at( j );
-            x[j] = x_mu->getX();
-            y[j] = x_mu->getY();
-            z[j] = x_mu->getZ();
+        for( int k = 0; k < 2; k++ ) {
+            z_xHit[k] = z_xSi[k];
+            z_yHit[k] = z_ySi[k];
+        }
+        zRadiator = zTopRadiator;
+        TrgUp = TrgDown = Dinode = 0; //not simulated
+        return;
+    }
+    
+    tree->Branch( "evNumber",     &evNumber,     "evNumber/I"    );
+    tree->Branch( "id",           &id,           "id/I"          );
+    tree->Branch( "energy",       &energy,       "energy/D"      );
+    tree->Branch( "nPos",         &nPos,         "nPos/I"        );
+    tree->Branch( "x",             x.data(),     "x[nPos]/D"     );
+    tree->Branch( "y",             y.data(),     "y[nPos]/D"     ); 
+    tree->Branch( "z",             z.data(),     "z[nPos]/D"     );
+    tree->Branch( "theta_out",    &theta_out,    "theta_out/D"   );
+    tree->Branch( "phi_out",      &phi_out,      "phi_out/D"     );
+    tree->Branch( "position_out", &position_out, "position_out/I");
+    tree->Branch( "x_PM",         &x_PM,         "x_PM/D"        );
+    tree->Branch( "y_PM",         &y_PM,         "y_PM/D"        );
+    tree->Branch( "z_PM",         &z_PM,         "z_PM/D"        );
+    tree->Branch( "phNumber",     &phNumber,     "phNumber/I"    );
+    tree->Branch( "weight",       &weight,       "weight/D"      );
+    
+    index = new TTree( "EventIndex", "Entries of each event in Cherenkov" );
+    index->Branch( "evNumber",    &evNumber,     "evNumber/I"    );
+    index->Branch( "firstEntry",  &firstEntry,   "firstEntry/L"  );
+    index->Branch( "nEntries",    &nEntries,     "nEntries/I"    );
+    
+}
+
+void SaveTree::fillPositions( std::vector<Vector>* positions ) {
+    
+    nPos = positions->size();
+    if( nPos > x.size() ) {
+        //the buffers are moved: give the new addresses to the tree
+        x.resize( 2*nPos );
+        y.resize( 2*nPos );
+        z.resize( 2*nPos );
+        tree->SetBranchAddress( "x", x.data() );
+        tree->SetBranchAddress( "y", y.data() );
+        tree->SetBranchAddress( "z", z.data() );
+    }
+    
+    for( int j = 0; j < nPos; j++ ) {
+        Vector& pos = positions->at( j );
+        x[j] = pos.getX();
+        y[j] = pos.getY();
+        z[j] = pos.getZ();
+    }
+}
+
+void SaveTree::fillHits( Muon* mu ) {
+    
+    //muon: straight line from its entry point in the radiator
+    Vector& x_0 = mu->getPositionList()->at( 0 );
+    double  tx  = tan( mu->getTheta() )*cos( mu->getPhi() );
+    double  ty  = tan( mu->getTheta() )*sin( mu->getPhi() );
+    xRadiator = x_0.getX() + xcenterRadiator;
+    yRadiator = x_0.getY() + ycenterRadiator;
+    for( int k = 0; k < 2; k++ ) {
+        xHit[k] = xRadiator + tx*( z_xHit[k] - zRadiator );
+        yHit[k] = yRadiator + ty*( z_yHit[k] - zRadiator );
+    }
+    theta_mu = cos( mu->getTheta() );
+    phi_mu   = cos( mu->getPhi() );
+    
+    //photons on the pixels: with the Russian roulette the yield of a pixel is the sum of the weights
+    double pixelWeights[nPixels];
+    for( int k = 0; k < nPixels; k++ ) {
+        PmtPixelCounts[k] = 0;
+        pixelWeights[k]   = 0;
+    }
+    std::vector<Photon>* phList = mu->getPhotonList();
+    for( int j = 0; j < phList->size(); j++ ) {
+        Photon& ph = phList->at( j );
+        if( ph.getPosition_out() != 1 ) continue;
+        Vector* last    = ph.getLastPosition();
+        int     channel = pmtChannel( last->getX(), last->getY() );
+        if( channel > 0 ) {
+            PmtPixelCounts[channel-1]++;
+            pixelWeights[channel-1] += ph.getWeight();
         }
+    }
+    //the analysis divides by 4 the pulse heights of the digitizer 31
+    for( int i = 0; i < nChannelsPmt; i++ ) {
+        PmtPulseHeight[i] = pixelWeights[activeChannels[i]-1]*( DgtzID[i] == 31 ? 4 : 1 );
+    }
+    
+    tree->Fill();
+}
+
+void SaveTree::fillEvent( Muon* mu, int ev ) {
+    
+    STATS_TIMER( SAVE );
+    
+    evNumber   = ev;
+    if( hits_only ) {
+        fillHits( mu );
+        return;
+    }
+    firstEntry = tree->GetEntries();
+    nEntries   = 1 + mu->getPhotonList()->size();
+    index->Fill();
+    
+    id = 13;
+    energy = mu->getEnergy();
+    
+    //muon positions
+    fillPositions( mu->getPositionList() );
+    
+    Vector* last = mu->getLastPosition();
+    position_out = 1;
+    theta_out = mu->getTheta();
+    phi_out = mu->getPhi();
+    x_PM = last->getX();
+    y_PM = last->getY();
+    z_PM = last->getZ();
+    phNumber = -999;
+    weight   = 1;
+    //fill tree with muon variables
+    tree->Fill();
+    
+    //Loop on photons
+    id = 22;
+    phNumber = 0;
+    for( std::vector<Photon>::iterator it = mu->getPhotonList()->begin(); it != mu->getPhotonList()->end(); it++ ) {
         
-        position_out = 1;
-        theta_out = mu->getTheta();
-        phi_out = mu->getPhi();
-        x_PM = x[nPos-1];
-        y_PM = y[nPos-1];
-        z_PM = z[nPos-1];
-        phNumber = -999;
-        //fill tree with muon variables
-        tree->Fill();
+        Photon* ph = &(*it);
+        energy = ph->getEnergy();
+        ++phNumber;
+        //photon positions
+        fillPositions( ph->getPositionList() );
+        
+        position_out = ph->getPosition_out();
+        weight    = ph->getWeight();
+        theta_out = ph->getThetaOut_ph();
+        phi_out   = ph->getPhiOut_ph();
         
-        //Loop on photons
-        id = 22;
-        phNumber = 0;
-        for( std::vector<Photon*>::iterator it = mu->getPhotonList()->begin(); it != mu->getPhotonList()->end(); it++ ) {
+        if( position_out == 1 ) {
+            last = ph->getLastPosition();
+            x_PM = last->getX();
+            y_PM = last->getY();
+            z_PM = last->getZ();
+        } else {
             x_PM = -999;
             y_PM = -999;
             z_PM = -999;
-            for( int j=0; j<length; j++ ) {
-                x[j] = y[j] = z[j] = -999;
-            }
-            
-            Photon* ph = *it;
-            energy = ph->getEnergy();
-            ++phNumber;
-            //Loop on photons positions
-            nPos = ph->getPositionList()->size();
-            for( int j = 0; j < nPos; j++ ) {
-                Vector* x_ph = ph->getPositionList()->at( j );
-                x[j] = x_ph->getX();
-                y[j] = x_ph->getY();
-                z[j] = x_ph->getZ();
-            }
-            position_out = ph->getPosition_out();
-            theta_out = ph->getThetaOut_ph();
-            phi_out   = ph->getPhiOut_ph();
-            
-            if( position_out == 1 ) {
-                x_PM = x[nPos-1];
-                y_PM = y[nPos-1];
-                z_PM = z[nPos-1];
-            }
-            
-            //fill tree with photon variables
-            tree->Fill();
         }
+        
+        //fill tree with photon variables
+        tree->Fill();
     }
     
+}
+
+void SaveTree::close() {
+    
+    file->cd();
     tree->Write();
+    if( index ) index->Write();
     file->Close();
-    std::cout << "* ...100\% completed!" << std::endl;
-};
+    
+}
@@ -0,0 +1,67 @@
+#ifndef SaveTree_h
+#define SaveTree_h
+#include "Muon.h"
+#include "Pmt.h"
+#include <string>
+#include <vector>
+
+class TFile;
+class TTree;
+
+//Writes the events in the Cherenkov TTree as soon as they are simulated: each event
+//is filled and can be deleted right after, so the memory does not grow with the run.
+//The tree EventIndex has one entry per event with the range of its entries in Cherenkov,
+//so that the tools can read one event without scanning the whole tree.
+//With hits_only the trajectories are not saved: the photons on the PM plane are counted in
+//the pixels of the Pmt (see Pmt.h) and each event is one entry with the branches of the
+//data (Data-Analysis/Reader.C), so that Data-Analysis/EventAnalysis.C runs on the MC.
+class SaveTree {
+
+public:
+    SaveTree( std::string file_name, bool hits_only = false );
+    void fillEvent( Muon* mu, int evNumber ); //one entry for the muon, one for each photon
+    void close();
+    
+private:
+    void fillPositions( std::vector<Vector>* positions );
+    void fillHits( Muon* mu );
+    
+    bool   hits_only;
+    
+    TFile* file;
+    TTree* tree;
+    TTree* index;
+    
+    int    evNumber;
+    int    id;
+    double energy;
+    int    nPos;                              //number of positions of the particle
+    std::vector<double> x;                    //the branches x[nPos], y[nPos], z[nPos] 
+    std::vector<double> y;                    //read only the first nPos elements
+    std::vector<double> z;
+    double theta_out;
+    double phi_out;
+    int    position_out;
+    double x_PM;
+    double y_PM;
+    double z_PM;
+    int    phNumber;
+    double weight;                            //weight of the photon (Russian roulette), 1 for the muon
+    long long firstEntry;                     //first entry of the event in Cherenkov
+    int    nEntries;                          //entries of the event: the muon and its photons
+    
+    //hits_only: the event as in the data
+    double xHit[2], yHit[2];                  //muon on the Si layers
+    double z_xHit[2], z_yHit[2];
+    double theta_mu, phi_mu;                  //cosines of the angles of the muon
+    int    DgtzID[nChannelsPmt];
+    int    PmtChannelID[nChannelsPmt];
+    double PmtPulseHeight[nChannelsPmt];      //sum of the weights of the photons on the pixel (x4 for the digitizer 31)
+    double PmtTime[nChannelsPmt];
+    double xRadiator, yRadiator, zRadiator;   //muon on the top of the radiator
+    double TrgUp, TrgDown, Dinode;
+    int    PmtPixelCounts[nPixels];           //photons on every pixel, channel-1
+    
+};
+
+#endif
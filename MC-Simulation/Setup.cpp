@@ -1,115 +1,124 @@
 #include <iostream>
 #include <cmath>
-#include <time.h>
 #include "Setup.h"
+#include "Random.h"
 
-Setup::Setup( std::string type, std::string ref ): type_of_detector( type ), reflection( ref ) {
+Setup::Setup( Config* config ) {
     
-    time_t timer;
-    GEN.seed( time(&timer) );
+    type_of_detector = config->getString( "detector", "c" );
+    reflection       = config->getString( "walls", "r" );
     
-    //Here you can set your detector's parameters   
-    n = 1.4; //refraction index
-    d = 100;   //cm distance of the trigger scintillators
-    PMdistance = 0.3; //cm distance of PM plane from radiator
+    //Default detector's parameters, they can be changed in the configuration
+    n = config->getDouble( "n", 1.4 ); //refraction index
+    d = config->getDouble( "d", 100 ); //cm distance of the trigger scintillators
+    PMdistance = config->getDouble( "PMdistance", 0.3 ); //cm distance of PM plane from radiator
     
-    if( type_of_detector == "c" ) {
+    geometry = ( type_of_detector == "p" ) ? BOX : CYLINDER;
+    if( geometry == CYLINDER ) {
         r = 1;  //cm radius
         h = 1; //cm height
     }
-    else if ( type_of_detector == "p" ) {
+    else if ( geometry == BOX ) {
         r = 6.0; //cm square basis dimension
         h = 1.0; //cm height
     }
+    cos_critical = sqrt( 1 - 1/n/n );
+    r = config->getDouble( "r", r );
+    h = config->getDouble( "h", h );
+    
+    //reflection/absorption threshold of the lateral walls
+    if( reflection != "r" && reflection != "a" ) {
+        std::cout << "* Unknown lateral walls " << reflection << ": using reflecting walls (r)" << std::endl;
+        reflection = "r";
+    }
+    threshold = ( reflection == "r" ) ? 0.2 : 0.999;
+    threshold = config->getDouble( "reflection_threshold", threshold );
     
     std::cout << "* Type of detector: " << type_of_detector << std::endl;
     std::cout << "* Dimensions of the detector: \n*   r = " << r << "\n*   h = " << h << std::endl;
     std::cout << "* Distance of trigger scintillators: \n*   d = " << d << std::endl;
     std::cout << "* Refraction index of the material: \n*   n = " << n << std::endl;
+    if( n*n >= 2 ) std::cout << "* n >= sqrt(2): the photons of a vertical muon are trapped by the total reflections" << std::endl;
 }
 
-Vector* Setup::generateInitialPoint() {
+Vector Setup::generateInitialPoint() {
     
     std::uniform_real_distribution<double> dist(0,1);
     double x_0, y_0;
     double sign_x_0, sign_y_0;
     
-    sign_x_0 = dist( GEN );
-    sign_y_0 = dist( GEN );
+    sign_x_0 = dist( gen );
+    sign_y_0 = dist( gen );
     
-    if( type_of_detector == "c" ) {
+    if( geometry == CYLINDER ) {
         if( sign_x_0 >= 0.5 && sign_x_0 < 1) {
-            x_0 =  r*dist( GEN );
+            x_0 =  r*dist( gen );
         } 
         else {
-            x_0 = -r*dist( GEN );
+            x_0 = -r*dist( gen );
         }
         if( sign_y_0 >= 0.5 && sign_y_0 < 1) {
-            y_0 =  sqrt( 1 - x_0*x_0/r/r )*dist( GEN );
+            y_0 =  sqrt( 1 - x_0*x_0/r/r )*dist( gen );
         }
         else {
-            y_0 = -sqrt( 1 - x_0*x_0/r/r )*dist( GEN );
+            y_0 = -sqrt( 1 - x_0*x_0/r/r )*dist( gen );
         }
     }
-    else if( type_of_detector == "p" ) {
+    else if( geometry == BOX ) {
         if( sign_x_0 >= 0.5 && sign_x_0 < 1) {
-            x_0 =  r/2*dist( GEN );
+            x_0 =  r/2*dist( gen );
         } 
         else {
-            x_0 = -r/2*dist( GEN );
+            x_0 = -r/2*dist( gen );
         }
         if( sign_y_0 >= 0.5 && sign_y_0 < 1) {
-            y_0 =  r/2*dist( GEN );
+            y_0 =  r/2*dist( gen );
         } 
         else {
-            y_0 = -r/2*dist( GEN );
+            y_0 = -r/2*dist( gen );
         }
     }
         
-    initialPoint = new Vector( x_0, y_0, 0 );
-    return initialPoint;
+    return Vector( x_0, y_0, 0 );
     
 }
 
-double* Setup::generateInitialAngle() {
+void Setup::generateInitialAngle( double* angle ) {
     
     std::uniform_real_distribution<double> dist(0, 1);
-    angle[1] = 2*M_PI*dist(GEN); //angle on x,y plane
+    angle[1] = 2*M_PI*dist(gen); //angle on x,y plane
+    angle[0] = getMaxAngle( angle[1] )*dist( gen );
+}
+
+double Setup::getMaxAngle( double phi ) {
     
-    double max_angle;           //max azimuthal angle
-    if( type_of_detector == "c" ) {
-        max_angle = atan2( r, d+h/2 );
-    }
-    else if( type_of_detector == "p" ) {
-        if( ( angle[0]>M_PI/4 && angle[0]<3*M_PI/4 ) || ( angle[0]>5*M_PI/4 && angle[0]<7*M_PI/4) ) {
-            max_angle = atan2( r/2/sin( angle[0] ), d+h/2 );
+    if( geometry == BOX ) {
+        if( ( phi>M_PI/4 && phi<3*M_PI/4 ) || ( phi>5*M_PI/4 && phi<7*M_PI/4) ) {
+            return atan2( r/2/fabs( sin( phi ) ), d+h/2 );
         } 
-        else {
-            max_angle = atan2( r/2/cos( angle[0] ), d+h/2 );
-        }
+        return atan2( r/2/fabs( cos( phi ) ), d+h/2 );
     }
-    
-    angle[0] = max_angle*dist( GEN );
-    
-    return angle;
+    return atan2( r, d+h/2 );
 }
     
 bool Setup::checkPosition( Vector* x ) {
-    
-    double xpos = x->getX(), ypos = x->getY(), zpos = x->getZ();
-    if( type_of_detector == "c" ) {
-        return ( sqrt( xpos*xpos + ypos*ypos ) < r && zpos < h && zpos >= 0.0); 
-    }
-    else if( type_of_detector == "p" ) {
-        return ( abs( xpos ) <= r/2 && abs( ypos ) <= r/2 && zpos < h && zpos >= 0.0 );
-    }
-    
+    if( geometry == CYLINDER ) return checkPosition<Cylinder>( x );
+    return checkPosition<Box>( x );
+}
+
+double Setup::distanceToWall( double x, double y, double z, double ux, double uy, double uz, Wall* wall ) {
+    if( geometry == CYLINDER ) return distanceToWall<Cylinder>( x, y, z, ux, uy, uz, wall );
+    return distanceToWall<Box>( x, y, z, ux, uy, uz, wall );
 }
 
 std::string Setup::getTypeOfDetector() {
     return type_of_detector;
 }
 
+GeometryType Setup::getGeometry() {
+    return geometry;
+}
+
 double Setup::getRefractionIndex() {
     return n;
 }
@@ -130,8 +139,10 @@ double Setup::getCriticalAngle() {
     return asin( 1/n );
 }
 
+double Setup::getCosCriticalAngle() {
+    return cos_critical;
+}
+
 double Setup::ReflectionThreshold() {
-    //here you can change the reflection/absorption threshold
-    if( reflection == "r" ) return 0.2;
-    if( reflection == "a" ) return 0.999;
+    return threshold;
 }
@@ -2,37 +2,77 @@
 #define Setup_h
 
 #include "Vector.h"
+#include "Config.h"
+#include "Geometry.h"
 #include <string>
-#include <random>
+
+//Faces of the radiator
+enum Wall { LATERAL, TOP, BOTTOM };
 
 class Setup {
 
 public:
-    Setup( std::string type, std::string ref );
-    Vector* generateInitialPoint();
-    double* generateInitialAngle();
-    std::string getTypeOfDetector();
+    Setup( Config* config ); //the parameters not given in the configuration take the default values
+    Vector  generateInitialPoint();
+    void    generateInitialAngle( double* angle ); //angle[0] = theta, angle[1] = phi
+    double  getMaxAngle( double phi );             //max polar angle of the muons accepted by the trigger
+    std::string  getTypeOfDetector();
+    GeometryType getGeometry();
     bool    checkPosition( Vector* x );
+    //Distance from (x,y,z) to the first wall along the unit vector (ux,uy,uz), and which wall it is
+    double  distanceToWall( double x, double y, double z, double ux, double uy, double uz, Wall* wall );
+    //Versions for a given shape G (Cylinder or Box), without the choice of the shape
+    template<class G> bool   checkPosition( Vector* x );
+    template<class G> double distanceToWall( double x, double y, double z, double ux, double uy, double uz, Wall* wall );
     double  getRadius();
     double  getHeight();
     double  getRefractionIndex();
     double  getCriticalAngle();
+    double  getCosCriticalAngle(); //the reflection angle is above the critical angle if its cosine is below this
+    //Total reflection for the cosine of the angle with the normal to the wall: the same test for
+    //all the walls and all the transports, so that a photon has the same fate in each of them
+    bool    totalReflection( double cos_incidence ) { return cos_incidence <= cos_critical; };
     double  getPMdistance();
     double  ReflectionThreshold();
     
 private:
     std::string type_of_detector;
     std::string reflection;
+    GeometryType geometry;
     double n;              //refraction index
     double r;              //cm radius 
     double h;              //cm height
     double d;              //cm distance from trigger scintillators
     double PMdistance;     //cm distance of PM plane from radiator
-    Vector* initialPoint;  //coordinates of initial point
-    double angle[2];       //rad initial angles
-    //std::mt19937 gen;
-    std::default_random_engine GEN;
+    double cos_critical;   //cosine of the critical angle
+    double threshold;      //a photon is reflected by the lateral walls if a random number is above threshold
     
 };
 
+template<class G> inline bool Setup::checkPosition( Vector* x ) {
+    return G::inside( x->getX(), x->getY(), x->getZ(), r, h );
+}
+
+template<class G> inline double Setup::distanceToWall( double x, double y, double z, double ux, double uy, double uz, Wall* wall ) {
+    
+    //top (z = 0) and bottom (z = h) faces
+    double t = INFINITY;
+    *wall = LATERAL;
+    if( uz > 0 ) {
+        t = ( h - z )/uz;
+        *wall = BOTTOM;
+    } else if( uz < 0 ) {
+        t = -z/uz;
+        *wall = TOP;
+    }
+    
+    //lateral walls
+    double t_lat = G::lateralDistance( x, y, ux, uy, r );
+    if( t_lat < t ) {
+        t = t_lat;
+        *wall = LATERAL;
+    }
+    return ( t > 0 ) ? t : 0;
+}
+
 #endif
@@ -0,0 +1,113 @@
+#include "Simulation.h"
+#include "Random.h"
+#include "PhotonBatch.h"
+#include "Stats.h"
+#include <iostream>
+#include <cmath>
+#include <mutex>
+
+static std::mutex print_mtx;
+
+//each thread keeps its batch, so the arrays are allocated only once
+static thread_local PhotonBatch batch;
+
+//Simulation of the event for a given shape G of the radiator (see Geometry.h)
+template<class G> static Muon* simulateEventGeometry( Setup* setup, SimOptions* options, long iEvent );
+
+Muon* simulateEvent( Setup* setup, SimOptions* options, long iEvent ) {
+    if( setup->getGeometry() == CYLINDER ) return simulateEventGeometry<Cylinder>( setup, options, iEvent );
+    return simulateEventGeometry<Box>( setup, options, iEvent );
+}
+
+template<class G> static Muon* simulateEventGeometry( Setup* setup, SimOptions* options, long iEvent ) {
+    
+    if( options->printEvents ) {
+        std::lock_guard<std::mutex> lock( print_mtx );
+        std::cout << "* ...generating event " << iEvent+1 << std::endl;
+    }
+    
+    seedEvent( options->seed, iEvent );
+    STATS_COUNT( EVENTS, 1 );
+    
+    //Generation and propagation of muons
+    Vector  x_0( 0, 0, 0 );
+    double  angle[2]; // element 0 = theta, element 1 = phi
+    double  energy = 4000; //MeV
+    {
+        STATS_TIMER( GENERATION );
+        if( options->generator ) {
+            options->generator->generate( &x_0, angle, &energy );
+        } else {
+            x_0 = setup->generateInitialPoint();
+            setup->generateInitialAngle( angle );
+        }
+    }
+    
+    Muon* mu = new Muon( x_0, energy, angle[0], angle[1] );
+    mu->setSpectrum( options->spectrum );
+    
+    {
+        STATS_TIMER( MUON );
+        if( options->muon == FAST ) {
+            mu->CherenkovTrack( setup );
+            STATS_COUNT( MUON_STEPS, 1 );
+        } else {
+            mu->updatePosition();
+            while ( setup->checkPosition<G>( mu->getLastPosition() ) == true ) {
+                //Generation of Cherenkov photons
+                mu->Cherenkov( setup->getRefractionIndex() ); 
+                mu->updatePosition();
+                STATS_COUNT( MUON_STEPS, 1 );
+            }
+        }
+    }
+    
+    mu->hitPM( setup->getPMdistance(), angle[0], angle[1] );
+    //Propagation of photons
+    std::vector<Photon>* phList = mu->getPhotonList();
+    
+    {
+        STATS_TIMER( PHOTONS );
+        for( int j=0; j < phList->size(); j++ ) {
+            //new projections in the global rf
+            phList->at( j ).rotateProjections( angle[0], angle[1] ); 
+            //the photons which cannot reach the PM plane are not transported
+            if( phList->at( j ).terminate( setup, &options->termination ) ) continue;
+            if( options->transport == BATCH ) {
+                batch.add( &phList->at( j ) );
+            } else if( options->transport == LUT ) {
+                options->table->sample( &phList->at( j ), setup );
+            } else if( options->transport == TRACE ) {
+                phList->at( j ).tracePh<G>( setup, &options->termination );
+            } else {
+                //new positions in the global rf
+                phList->at( j ).propagatePh<G>( setup, &options->termination );
+            }
+        }
+        
+        if( options->transport == BATCH ) {
+            batch.propagate<G>( setup, &options->termination );
+            batch.clear();
+        }
+    }
+    
+    STATS_TIMER( PM );
+    for( int j=0; j < phList->size(); j++ ) {
+        if( phList->at( j ).getPosition_out() == 1 && options->transport == LUT ) {
+            //the table gives directly the hit point on the PM plane
+            STATS_COUNT( PHOTONS_PM, 1 );
+        } else if( phList->at( j ).getPosition_out() == 1 ) {
+            double theta_prime = asin( phList->at( j ).getRefractionIndex( setup )*sin( phList->at( j ).getThetaOut_ph() ) );
+            double phi_prime   = phList->at( j ).getPhiOut_ph();
+            
+            phList->at( j ).hitPM( setup->getPMdistance(), theta_prime, phi_prime );
+            STATS_COUNT( PHOTONS_PM, 1 );
+        } else if( phList->at( j ).getPosition_out() == -1 ) {
+            STATS_COUNT( EXIT_TOP, 1 );
+        } else if( !phList->at( j ).isKilled() ) {
+            STATS_COUNT( ABSORBED, 1 );
+        }
+    }
+    
+    return mu;
+}
@@ -0,0 +1,40 @@
+#ifndef Simulation_h
+#define Simulation_h
+#include "Setup.h"
+#include "Muon.h"
+#include "AcceptanceTable.h"
+#include "CosmicGenerator.h"
+#include "Spectrum.h"
+
+//Algorithms for the propagation of the photons
+enum Transport {
+    STEP,   //each photon is moved step by step (Photon::updatePositionPh)
+    BATCH,  //all the photons of the event are moved together (PhotonBatch)
+    TRACE,  //each photon jumps from wall to wall (Photon::tracePh)
+    LUT     //each photon takes the fate of a photon of the acceptance table (AcceptanceTable)
+};
+
+//Algorithms for the propagation of the muon
+enum MuonTracking {
+    FULL,   //the muon is moved step by step and all its positions are saved (Muon::Cherenkov)
+    FAST    //the muon crosses the radiator at once, only entry and exit points are saved (Muon::CherenkovTrack)
+};
+
+//Options of the run which are not properties of the detector
+struct SimOptions {
+    SimOptions() : seed( 0 ), transport( STEP ), muon( FULL ), printEvents( true ), table( NULL ), generator( NULL ), spectrum( NULL ) {};
+    unsigned long seed;       //master seed of the random streams
+    Transport     transport;
+    MuonTracking  muon;
+    bool          printEvents; //prints a line at the beginning of each event
+    AcceptanceTable* table;    //table of the transport LUT
+    CosmicGenerator* generator; //spectrum of the cosmic muons; NULL: muons of 4000 MeV, uniform in the acceptance
+    Spectrum*        spectrum;  //emission of the detected photons only; NULL: all the photons at one wavelength
+    Termination      termination; //photons killed before they leave the radiator (see Photon.h)
+};
+
+//Generates and propagates the muon of event number iEvent (starting from 0) and its
+//Cherenkov photons. The random numbers are taken from the stream of the event (see Random.h).
+Muon* simulateEvent( Setup* setup, SimOptions* options, long iEvent );
+
+#endif
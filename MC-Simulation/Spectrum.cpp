@@ -0,0 +1,112 @@
+#include "Spectrum.h"
+#include "Random.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+bool Spectrum::readTable( std::string file_name, std::vector<double>* x, std::vector<double>* y ) {
+
+    std::ifstream file( file_name.c_str() );
+    if( !file.is_open() ) {
+        std::cout << "* Cannot open the table " << file_name << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while( std::getline( file, line ) ) {
+        std::istringstream values( line.substr( 0, line.find( '#' ) ) );
+        double x_i, y_i;
+        if( !( values >> x_i >> y_i ) ) continue;
+        if( !x->empty() && x_i <= x->back() ) {
+            std::cout << "* " << file_name << ": the wavelengths must be increasing" << std::endl;
+            return false;
+        }
+        x->push_back( x_i );
+        y->push_back( y_i );
+    }
+
+    if( x->size() < 2 ) {
+        std::cout << "* " << file_name << ": less than two points" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+double Spectrum::interpolate( const std::vector<double>& x, const std::vector<double>& y, double x_0 ) {
+
+    if( x_0 <= x.front() ) return y.front();
+    if( x_0 >= x.back() ) return y.back();
+    int i = 1;
+    while( x[i] < x_0 ) i++;
+    return y[i-1] + ( y[i] - y[i-1] )*( x_0 - x[i-1] )/( x[i] - x[i-1] );
+}
+
+Spectrum::Spectrum( Config* config ) : loaded( false ), lambdaMin( 0 ), dlambda( 1 ), yield( 0 ), nMax( 0 ), meanIndex( 0 ) {
+
+    std::string dispersion = config->getString( "dispersion", "./data/PMMA_refractive_index.dat" );
+    std::string qe         = config->getString( "qe", "./data/H8500_QE.dat" );
+    std::vector<double> lambda_n, n, lambda_qe, efficiency;
+    if( !readTable( dispersion, &lambda_n, &n ) || !readTable( qe, &lambda_qe, &efficiency ) ) return;
+
+    //bins of 1 nm where both the tables are defined
+    lambdaMin   = ceil( std::max( lambda_n.front(), lambda_qe.front() ) );
+    int nBins   = floor( std::min( lambda_n.back(), lambda_qe.back() ) ) - lambdaMin;
+    if( nBins <= 0 ) {
+        std::cout << "* The wavelengths of " << dispersion << " and " << qe << " do not overlap" << std::endl;
+        return;
+    }
+
+    index.resize( nBins );
+    std::vector<double> weights( nBins );
+    double sum = 0, trapped = 0;
+    for( int i = 0; i < nBins; i++ ) {
+        double l   = lambdaMin + ( i + 0.5 )*dlambda;
+        index[i]   = interpolate( lambda_n, n, l );
+        double sin2 = std::max( 0.0, 1 - 1/index[i]/index[i] ); //sin^2 of the Cherenkov angle for beta = 1
+        weights[i] = std::max( 0.0, interpolate( lambda_qe, efficiency, l ) )*sin2/l/l*dlambda;
+        sum       += weights[i];
+        meanIndex += weights[i]*index[i];
+        if( weights[i] > 0 ) nMax = std::max( nMax, index[i] );
+        if( index[i]*index[i] >= 2 ) trapped += weights[i];
+    }
+    if( sum <= 0 ) {
+        std::cout << "* No photons can be detected with " << dispersion << " and " << qe << std::endl;
+        return;
+    }
+    table.build( weights );
+    yield     = 2*M_PI*( 1.0/137 )*sum*10000000; //cm^-1
+    meanIndex = meanIndex/sum;
+    loaded    = true;
+
+    std::cout << "* Emission spectrum: " << lambdaMin << " - " << lambdaMin + nBins*dlambda << " nm, "
+              << yield << " detected photons/cm for beta = 1, mean n = " << meanIndex << std::endl;
+    //for n >= sqrt(2) the photons of a vertical muon hit the bottom face beyond the critical angle
+    //and the lateral reflections do not change dir_z: only the inclined muons can bring them out
+    if( trapped > 0 ) std::cout << "* " << int( 100*trapped/sum ) << "\% of the photons have n >= sqrt(2): "
+                                << "they do not reach the PM from a vertical muon" << std::endl;
+}
+
+bool Spectrum::isLoaded() {
+    return loaded;
+}
+
+double Spectrum::getLambdaC( double beta ) {
+    if( beta*nMax <= 1 ) return INFINITY;
+    return 1/yield;
+}
+
+double Spectrum::sample( double beta, double* n ) {
+
+    std::uniform_real_distribution<double> unif_dist(0,1);
+    int i = table.sample( unif_dist( gen ) );
+    *n    = index[i];
+    //the table is made for beta = 1
+    double sin2 = 1 - 1/( beta*beta*index[i]*index[i] );
+    if( beta < 1 && unif_dist( gen )*( 1 - 1/index[i]/index[i] ) >= sin2 ) return 0;
+    return lambdaMin + ( i + unif_dist( gen ) )*dlambda;
+}
+
+double Spectrum::getMeanIndex() {
+    return meanIndex;
+}
@@ -0,0 +1,42 @@
+#ifndef Spectrum_h
+#define Spectrum_h
+#include "Config.h"
+#include "AliasTable.h"
+#include <string>
+#include <vector>
+
+//Spectrum of the detected Cherenkov photons, from the tables of the refraction index n(lambda)
+//of the radiator and of the quantum efficiency QE(lambda) of the PM (files of two columns,
+//wavelength in nm and value, read once at the beginning of the run). The number of detected
+//photons per unit length and wavelength is
+//   d2N/dx dlambda = 2 pi alpha QE(lambda) (1 - 1/(beta^2 n(lambda)^2)) / lambda^2
+//and is tabulated in bins of 1 nm for beta = 1 (alias table). A photon is emitted only if it
+//is detected: its wavelength is drawn from the table and, for beta < 1, it is kept with
+//probability (1 - 1/(beta^2 n^2))/(1 - 1/n^2), so the photons that the PM would not see are
+//never created.
+class Spectrum {
+
+public:
+    Spectrum( Config* config );
+    bool   isLoaded();
+    double getLambdaC( double beta );   //cm mean distance between two detected photons (before the choice of beta)
+    //wavelength (nm) of a detected photon emitted by a particle of speed beta and the refraction
+    //index n at that wavelength; 0 if the photon is not emitted
+    double sample( double beta, double* n );
+    double getMeanIndex();              //mean refraction index of the detected photons (beta = 1)
+
+private:
+    static bool   readTable( std::string file_name, std::vector<double>* x, std::vector<double>* y );
+    static double interpolate( const std::vector<double>& x, const std::vector<double>& y, double x_0 );
+    bool        loaded;
+    double      lambdaMin;              //nm lower edge of the first bin
+    double      dlambda;                //nm width of the bins
+    std::vector<double> index;          //refraction index at the centre of each bin
+    AliasTable  table;
+    double      yield;                  //detected photons per cm for beta = 1
+    double      nMax;                   //no photons if beta*nMax <= 1
+    double      meanIndex;
+
+};
+
+#endif
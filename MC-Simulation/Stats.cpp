@@ -0,0 +1,88 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include "Stats.h"
+
+#ifdef CHERENKOV_STATS
+static const char* counter_names[N_COUNTERS] = {
+    "events", "muon_steps", "photons_generated", "photon_steps", "reflections_top_bottom",
+    "reflections_lateral", "exit_top", "absorbed", "killed", "photons_PM"
+};
+
+static const char* stage_names[N_STAGES] = {
+    "generation", "muon", "photons", "PM", "save"
+};
+
+thread_local ThreadStats stats;
+
+static std::mutex          stats_mtx;
+static std::vector<Stats*> stats_threads; //the counters of the running threads
+static Stats               stats_ended;   //sum of the counters of the threads already ended
+
+ThreadStats::ThreadStats() {
+    std::lock_guard<std::mutex> lock( stats_mtx );
+    stats_threads.push_back( this );
+}
+
+ThreadStats::~ThreadStats() {
+    std::lock_guard<std::mutex> lock( stats_mtx );
+    for( int i = 0; i < N_COUNTERS; i++ ) stats_ended.counters[i] += counters[i];
+    for( int i = 0; i < N_STAGES; i++ ) stats_ended.seconds[i] += seconds[i];
+    stats_threads.erase( std::find( stats_threads.begin(), stats_threads.end(), this ) );
+}
+#endif
+
+void Stats::clear() {
+    for( int i = 0; i < N_COUNTERS; i++ ) counters[i] = 0;
+    for( int i = 0; i < N_STAGES; i++ ) seconds[i] = 0;
+}
+
+void resetStats() {
+#ifdef CHERENKOV_STATS
+    std::lock_guard<std::mutex> lock( stats_mtx );
+    stats_ended.clear();
+    for( int i = 0; i < stats_threads.size(); i++ ) stats_threads[i]->clear();
+#endif
+}
+
+void printStats( std::string json_file ) {
+    
+#ifndef CHERENKOV_STATS
+    if( !json_file.empty() ) std::cout << "* Statistics not available: compile with make STATS=1" << std::endl;
+#else
+    Stats total;
+    {
+        std::lock_guard<std::mutex> lock( stats_mtx );
+        total = stats_ended;
+        for( int t = 0; t < stats_threads.size(); t++ ) {
+            for( int i = 0; i < N_COUNTERS; i++ ) total.counters[i] += stats_threads[t]->counters[i];
+            for( int i = 0; i < N_STAGES; i++ ) total.seconds[i] += stats_threads[t]->seconds[i];
+        }
+    }
+    
+    //the times are summed over the threads
+    std::cout << "* Statistics of the run:" << std::endl;
+    for( int i = 0; i < N_COUNTERS; i++ ) {
+        std::cout << "*   " << counter_names[i] << ": " << total.counters[i] << std::endl;
+    }
+    std::cout << "* Time spent in each stage (s, summed over the threads):" << std::endl;
+    for( int i = 0; i < N_STAGES; i++ ) {
+        std::cout << "*   " << stage_names[i] << ": " << total.seconds[i] << std::endl;
+    }
+    
+    if( json_file.empty() ) return;
+    std::ofstream json( json_file.c_str() );
+    json << "{\n  \"counters\": {\n";
+    for( int i = 0; i < N_COUNTERS; i++ ) {
+        json << "    \"" << counter_names[i] << "\": " << total.counters[i] << ( i+1 < N_COUNTERS ? ",\n" : "\n" );
+    }
+    json << "  },\n  \"seconds\": {\n";
+    for( int i = 0; i < N_STAGES; i++ ) {
+        json << "    \"" << stage_names[i] << "\": " << total.seconds[i] << ( i+1 < N_STAGES ? ",\n" : "\n" );
+    }
+    json << "  }\n}\n";
+    std::cout << "* Statistics written in " << json_file << std::endl;
+#endif
+}
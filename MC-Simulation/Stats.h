@@ -0,0 +1,74 @@
+#ifndef Stats_h
+#define Stats_h
+#include <string>
+#include <chrono>
+
+//Counters and timers of the simulation. They are compiled only with -DCHERENKOV_STATS
+//(make STATS=1): otherwise the macros STATS_COUNT and STATS_TIMER are empty, the counters
+//of the threads do not exist and the simulation runs at full speed. Each thread updates its own copy of the counters, the
+//copies are summed only at the end of the run.
+
+enum StatsCounter {
+    EVENTS,                  //simulated events
+    MUON_STEPS,              //steps of the muon in the radiator
+    PHOTONS_GENERATED,       //Cherenkov photons
+    PHOTON_STEPS,            //steps (or wall to wall segments) of the photons
+    REFLECTIONS_TOP_BOTTOM,  //total reflections on the top/bottom faces
+    REFLECTIONS_LATERAL,     //reflections on the lateral walls
+    EXIT_TOP,                //photons going out from the top face
+    ABSORBED,                //photons absorbed by the lateral walls or trapped by total reflections
+    PHOTONS_KILLED,          //photons killed by the termination (--termination, --roulette_reflections)
+    PHOTONS_PM,              //photons reaching the PM plane
+    N_COUNTERS
+};
+
+enum StatsStage {
+    GENERATION,              //initial point and angle of the muon
+    MUON,                    //propagation of the muon and emission of the photons
+    PHOTONS,                 //propagation of the photons
+    PM,                      //propagation to the PM plane
+    SAVE,                    //writing of the events in the TTree
+    N_STAGES
+};
+
+struct Stats {
+    Stats() { clear(); };
+    void clear();
+    long   counters[N_COUNTERS];
+    double seconds[N_STAGES];
+};
+
+#ifdef CHERENKOV_STATS
+//Counters of one thread, registered for the summary of the run
+struct ThreadStats : public Stats {
+    ThreadStats();
+    ~ThreadStats();          //the counters of a thread that ends are added to the total
+};
+
+extern thread_local ThreadStats stats;
+
+//Adds the time from the construction to the destruction to the stage
+class StatsTimer {
+public:
+    StatsTimer( StatsStage s ) : stage( s ), start( std::chrono::steady_clock::now() ) {};
+    ~StatsTimer() { stats.seconds[stage] += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count(); };
+private:
+    StatsStage stage;
+    std::chrono::steady_clock::time_point start;
+};
+#endif
+
+void resetStats();                          //to be called when no event is being simulated
+void printStats( std::string json_file );   //summary of the run, also in JSON if json_file is not empty
+
+#ifdef CHERENKOV_STATS
+#define STATS_CONCAT_( a, b ) a##b
+#define STATS_CONCAT( a, b )  STATS_CONCAT_( a, b )
+#define STATS_COUNT( counter, n ) ( stats.counters[counter] += (n) )
+#define STATS_TIMER( stage ) StatsTimer STATS_CONCAT( stats_timer_, __LINE__ )( stage )
+#else
+#define STATS_COUNT( counter, n ) ( (void)0 )
+#define STATS_TIMER( stage )      ( (void)0 )
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool( int nThreads ) : next(0), nTasks(0), generation(0), nBusy(0), stop(false) {
+    if( nThreads < 1 ) nThreads = 1;
+    for( int i = 0; i < nThreads; i++ ) {
+        workers.push_back( std::thread( &ThreadPool::work, this ) );
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock( mtx );
+        stop = true;
+    }
+    cv_start.notify_all();
+    for( int i = 0; i < workers.size(); i++ ) workers[i].join();
+}
+
+void ThreadPool::start( long n, std::function<void(long)> t ) {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock( mtx );
+        task   = t;
+        nTasks = n;
+        next   = 0;
+        nBusy  = workers.size();
+        generation++;
+    }
+    cv_start.notify_all();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock( mtx );
+    cv_done.wait( lock, [this]{ return nBusy == 0; } );
+}
+
+int ThreadPool::getNThreads() {
+    return workers.size();
+}
+
+void ThreadPool::work() {
+    long seen = 0;
+    while( true ) {
+        {
+            std::unique_lock<std::mutex> lock( mtx );
+            cv_start.wait( lock, [this, seen]{ return stop || generation != seen; } );
+            if( stop ) return;
+            seen = generation;
+        }
+        for( long i = next++; i < nTasks; i = next++ ) {
+            task( i );
+        }
+        {
+            std::lock_guard<std::mutex> lock( mtx );
+            nBusy--;
+        }
+        cv_done.notify_all();
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef ThreadPool_h
+#define ThreadPool_h
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//Pool of worker threads. start() hands out the task indices 0..nTasks-1 one at a time:
+//a thread takes the next index as soon as it is free, so the load stays balanced
+//even if some events take much longer than others.
+class ThreadPool {
+
+public:
+    ThreadPool( int nThreads );
+    ~ThreadPool();
+    void start( long nTasks, std::function<void(long)> task ); //returns immediately
+    void wait();                                               //waits for the end of all the tasks
+    int  getNThreads();
+    
+private:
+    void work();
+    
+    std::vector<std::thread>  workers;
+    std::mutex                mtx;
+    std::condition_variable   cv_start;
+    std::condition_variable   cv_done;
+    std::function<void(long)> task;
+    std::atomic<long>         next;
+    long                      nTasks;
+    long                      generation; //incremented at each start()
+    int                       nBusy;
+    bool                      stop;
+    
+};
+
+#endif
@@ -5,6 +5,10 @@ x( x_0 ), y( y_0 ), z( z_0 ) {
     
 }
 
+Vector::~Vector() {
+    
+}
+
 double Vector::getX() {
     return x;
 }
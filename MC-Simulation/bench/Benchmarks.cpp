@@ -0,0 +1,188 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <cmath>
+#include "../Config.h"
+#include "../Setup.h"
+#include "../Muon.h"
+#include "../Photon.h"
+#include "../SaveTree.h"
+#include "../Random.h"
+#include "../Simulation.h"
+#include "../CosmicGenerator.h"
+
+//Benchmarks of the simulation kernels and of the whole event.
+//The rates are reported as items_per_second: steps, positions, events or particles.
+
+//Setup with the default parameters for the given detector and walls
+static Setup* makeSetup( const char* detector, const char* walls ) {
+    Config config;
+    config.set( "detector", detector );
+    config.set( "walls", walls );
+    Particle::setParticlesData( &config );
+    return new Setup( &config );
+}
+
+//One step of the muon with the emission of the Cherenkov photons
+static void BM_MuonCherenkov( benchmark::State& state ) {
+    Setup* setup = makeSetup( "c", "r" );
+    double n     = setup->getRefractionIndex();
+    const int nSteps = 1000;
+    seedEvent( 1, 0 );
+    for( auto _ : state ) {
+        Muon mu( Vector( 0, 0, 0 ), 4000, 0, 0 );
+        for( int i = 0; i < nSteps; i++ ) {
+            mu.Cherenkov( n );
+            mu.updatePosition();
+        }
+        benchmark::DoNotOptimize( mu.getPhotonList()->size() );
+    }
+    state.SetItemsProcessed( state.iterations()*nSteps );
+    delete setup;
+}
+BENCHMARK( BM_MuonCherenkov );
+
+//Propagation of a photon emitted in the centre of the radiator, until it leaves it
+static void propagatePhoton( benchmark::State& state, const char* detector, const char* walls, bool trace ) {
+    Setup* setup = makeSetup( detector, walls );
+    std::uniform_real_distribution<double> dist( 0, 1 );
+    seedEvent( 1, 0 );
+    long nPositions = 0;
+    for( auto _ : state ) {
+        double theta = acos( 1/0.9/setup->getRefractionIndex() );
+        Photon ph( Vector( 0, 0, setup->getHeight()/2 ), 197.4/300e6, theta, 2*M_PI*dist( gen ) );
+        ph.rotateProjections( 0.5*dist( gen ), 2*M_PI*dist( gen ) );
+        if( trace ) {
+            ph.tracePh( setup );
+        } else {
+            while( setup->checkPosition( ph.getLastPosition() ) ) ph.updatePositionPh( setup );
+        }
+        nPositions += ph.getPositionList()->size();
+    }
+    state.SetItemsProcessed( nPositions );
+    delete setup;
+}
+static void BM_PhotonUpdatePosition( benchmark::State& state, const char* detector, const char* walls ) {
+    propagatePhoton( state, detector, walls, false );
+}
+static void BM_PhotonTrace( benchmark::State& state, const char* detector, const char* walls ) {
+    propagatePhoton( state, detector, walls, true );
+}
+BENCHMARK_CAPTURE( BM_PhotonUpdatePosition, c_r, "c", "r" );
+BENCHMARK_CAPTURE( BM_PhotonUpdatePosition, p_a, "p", "a" );
+BENCHMARK_CAPTURE( BM_PhotonTrace, c_r, "c", "r" );
+BENCHMARK_CAPTURE( BM_PhotonTrace, p_a, "p", "a" );
+
+//Check of random positions around the radiator
+static void BM_CheckPosition( benchmark::State& state, const char* detector ) {
+    Setup* setup = makeSetup( detector, "r" );
+    std::uniform_real_distribution<double> dist( -1, 1 );
+    seedEvent( 1, 0 );
+    std::vector<Vector> points;
+    for( int i = 0; i < 1024; i++ ) {
+        points.push_back( Vector( setup->getRadius()*dist( gen ), setup->getRadius()*dist( gen ), setup->getHeight()*dist( gen ) ) );
+    }
+    for( auto _ : state ) {
+        int nInside = 0;
+        for( int i = 0; i < points.size(); i++ ) nInside += setup->checkPosition( &points[i] );
+        benchmark::DoNotOptimize( nInside );
+    }
+    state.SetItemsProcessed( state.iterations()*points.size() );
+    delete setup;
+}
+BENCHMARK_CAPTURE( BM_CheckPosition, c, "c" );
+BENCHMARK_CAPTURE( BM_CheckPosition, p, "p" );
+
+static void BM_GenerateInitialPoint( benchmark::State& state, const char* detector ) {
+    Setup* setup = makeSetup( detector, "r" );
+    seedEvent( 1, 0 );
+    for( auto _ : state ) {
+        Vector x_0 = setup->generateInitialPoint();
+        benchmark::DoNotOptimize( x_0 );
+    }
+    state.SetItemsProcessed( state.iterations() );
+    delete setup;
+}
+BENCHMARK_CAPTURE( BM_GenerateInitialPoint, c, "c" );
+BENCHMARK_CAPTURE( BM_GenerateInitialPoint, p, "p" );
+
+static void BM_GenerateInitialAngle( benchmark::State& state, const char* detector ) {
+    Setup* setup = makeSetup( detector, "r" );
+    seedEvent( 1, 0 );
+    for( auto _ : state ) {
+        double angle[2];
+        setup->generateInitialAngle( angle );
+        benchmark::DoNotOptimize( angle );
+    }
+    state.SetItemsProcessed( state.iterations() );
+    delete setup;
+}
+BENCHMARK_CAPTURE( BM_GenerateInitialAngle, c, "c" );
+BENCHMARK_CAPTURE( BM_GenerateInitialAngle, p, "p" );
+
+//Cosmic muons generated in batches of 1024 from precomputed uniform numbers
+static void BM_CosmicGenerator( benchmark::State& state, const char* detector ) {
+    Setup* setup = makeSetup( detector, "r" );
+    Config config;
+    CosmicGenerator generator( setup, &config );
+    const int n = 1024;
+    std::vector<double> u( CosmicGenerator::nUniform*n ), x( n ), y( n ), theta( n ), phi( n ), energy( n );
+    std::uniform_real_distribution<double> dist(0,1);
+    seedEvent( 1, 0 );
+    for( size_t i = 0; i < u.size(); i++ ) u[i] = dist( gen );
+    for( auto _ : state ) {
+        generator.generate( n, u.data(), x.data(), y.data(), theta.data(), phi.data(), energy.data() );
+        benchmark::DoNotOptimize( energy.data() );
+    }
+    state.SetItemsProcessed( state.iterations()*n );
+    delete setup;
+}
+BENCHMARK_CAPTURE( BM_CosmicGenerator, c, "c" );
+BENCHMARK_CAPTURE( BM_CosmicGenerator, p, "p" );
+
+//Writing of one event (muon and photons) in the TTree
+static void BM_SaveTree( benchmark::State& state ) {
+    Setup*     setup = makeSetup( "c", "r" );
+    SimOptions options;
+    options.seed        = 1;
+    options.printEvents = false;
+    Muon*      mu       = simulateEvent( setup, &options, 0 );
+    SaveTree*  saveTree = new SaveTree( "./bench/bench_tree.root" );
+    int        ev       = 0;
+    for( auto _ : state ) saveTree->fillEvent( mu, ++ev );
+    saveTree->close();
+    state.SetItemsProcessed( state.iterations()*( 1 + mu->getPhotonList()->size() ) );
+    delete saveTree;
+    delete mu;
+    delete setup;
+}
+BENCHMARK( BM_SaveTree );
+
+//Whole events: generation of the muon, emission and propagation of the photons
+static void BM_Event( benchmark::State& state, const char* detector, const char* walls, Transport transport, MuonTracking muon ) {
+    Setup*     setup = makeSetup( detector, walls );
+    SimOptions options;
+    options.seed        = 1;
+    options.transport   = transport;
+    options.muon        = muon;
+    options.printEvents = false;
+    long iEvent = 0;
+    for( auto _ : state ) {
+        Muon* mu = simulateEvent( setup, &options, iEvent++ );
+        delete mu;
+    }
+    state.SetItemsProcessed( state.iterations() );
+    delete setup;
+}
+//names: detector_walls_transport_muon
+BENCHMARK_CAPTURE( BM_Event, c_r_step_full,  "c", "r", STEP,  FULL )->Unit( benchmark::kMicrosecond );
+BENCHMARK_CAPTURE( BM_Event, c_a_step_full,  "c", "a", STEP,  FULL )->Unit( benchmark::kMicrosecond );
+BENCHMARK_CAPTURE( BM_Event, p_r_step_full,  "p", "r", STEP,  FULL )->Unit( benchmark::kMicrosecond );
+BENCHMARK_CAPTURE( BM_Event, p_a_step_full,  "p", "a", STEP,  FULL )->Unit( benchmark::kMicrosecond );
+BENCHMARK_CAPTURE( BM_Event, c_r_batch_full, "c", "r", BATCH, FULL )->Unit( benchmark::kMicrosecond );
+BENCHMARK_CAPTURE( BM_Event, p_a_batch_full, "p", "a", BATCH, FULL )->Unit( benchmark::kMicrosecond );
+BENCHMARK_CAPTURE( BM_Event, c_r_trace_full, "c", "r", TRACE, FULL )->Unit( benchmark::kMicrosecond );
+BENCHMARK_CAPTURE( BM_Event, p_a_trace_full, "p", "a", TRACE, FULL )->Unit( benchmark::kMicrosecond );
+BENCHMARK_CAPTURE( BM_Event, c_r_trace_fast, "c", "r", TRACE, FAST )->Unit( benchmark::kMicrosecond );
+BENCHMARK_CAPTURE( BM_Event, p_a_trace_fast, "p", "a", TRACE, FAST )->Unit( benchmark::kMicrosecond );
+
+BENCHMARK_MAIN();
@@ -3,6 +3,15 @@ from matplotlib import pyplot as plt
 from matplotlib import cm
 from mpl_toolkits.mplot3d import Axes3D
 from scipy.linalg import norm
+import sys
+import EventDisplayFile
+
+#usage: python EventDisplay.py [file.evd] [evNumber]
+#with no evNumber the first event of the file is displayed
+file_name = sys.argv[1] if len(sys.argv) > 1 else "event_display.evd"
+events = EventDisplayFile.load(file_name)
+evNumber = int(sys.argv[2]) if len(sys.argv) > 2 else next(iter(events))
+event = events[evNumber]
 
 fig = plt.figure()
 ax = fig.add_subplot(111, projection='3d')
@@ -32,15 +41,11 @@ t, theta = np.meshgrid(t, theta)
 #generate coordinates for surface
 X, Y, Z = [v[i] * t + R * np.sin(theta) * n1[i] + R * np.cos(theta) * n2[i] for i in [0, 1, 2]]
 ax.plot_surface(X, Y, Z, cmap=cm.Blues, linewidth=0, antialiased=False)
-#load muon coordinates
-mu_xdata = np.loadtxt("mu_x.txt")
-mu_ydata = np.loadtxt("mu_y.txt")
-mu_zdata = np.loadtxt("mu_z.txt")
+#muon coordinates
+mu_xdata, mu_ydata, mu_zdata = event[EventDisplayFile.MUON].T
 mu = ax.scatter3D(mu_xdata, mu_ydata, mu_zdata, s=2, c=mu_zdata, cmap=cm.Reds);
-#load photons coordinates
-ph_xdata = np.loadtxt("ph_x.txt")
-ph_ydata = np.loadtxt("ph_y.txt")
-ph_zdata = np.loadtxt("ph_z.txt")
+#photons coordinates
+ph_xdata, ph_ydata, ph_zdata = event[EventDisplayFile.PHOTONS].T
 ph = ax.scatter3D(ph_xdata, ph_ydata, ph_zdata, s=2, c=ph_zdata, cmap=cm.Greens);
 #space axis
 ax.set_xlim(-2.6, 2.6)
@@ -59,4 +64,4 @@ ph_cbar = fig.colorbar(ph, ticks=[1, 2, 3, 4, 5, 6, 7], shrink=0.8)
 ph_cbar.ax.set_ylabel('z coordinate of photons [cm]')
 
 #plt.show()
-plt.savefig('79_EventDisplay.png')
+plt.savefig('%i_EventDisplay.png' % evNumber)
@@ -0,0 +1,45 @@
+/************************************************************************
+*			EventDisplayFile.h                    		*
+*************************************************************************
+* Binary file for the event displays (EventDisplay.py, Plot3DEvent.ipynb)	*
+* All the words are 4 bytes, little endian:				*
+*  -> file header:  int32 magic "CHEV", int32 version			*
+*  -> any number of blocks, appended one after the other:		*
+*     int32 evNumber, int32 kind, int32 nRows, int32 nCols,		*
+*     nRows*nCols float32 (row by row)					*
+* kind: 0 muon positions (x,y,z), 1 photon positions (x,y,z),		*
+*       2 data track points (x,y,z), 3 data Pmt hits (channel, PH)	*
+* Since every word is 4 bytes the whole file can be mapped as float32	*
+* (np.memmap) and the headers read as int32: see EventDisplayFile.py.	*
+*************************************************************************/
+
+#ifndef EventDisplayFile_h
+#define EventDisplayFile_h
+
+#include <cstdio>
+#include <vector>
+
+const int EVD_MAGIC   = 0x56454843; // "CHEV"
+const int EVD_VERSION = 1;
+enum EventDisplayKind { EVD_MUON = 0, EVD_PHOTONS = 1, EVD_TRACE = 2, EVD_HITS = 3 };
+
+// Appends a block of nCols columns to the file, which is created with its header if it does not exist
+bool writeEventBlock( const char* file_name, int evNumber, int kind, int nCols, const std::vector<float> &data ) {
+    
+    FILE* f = fopen(file_name,"ab");
+    if( !f ) {
+        printf("ERROR: unable to open %s\n",file_name);
+        return false;
+    }
+    if( ftell(f) == 0 ) {
+        int header[2] = { EVD_MAGIC, EVD_VERSION };
+        fwrite(header,sizeof(int),2,f);
+    }
+    int block[4] = { evNumber, kind, (int)(data.size()/nCols), nCols };
+    fwrite(block,sizeof(int),4,f);
+    fwrite(data.data(),sizeof(float),data.size(),f);
+    fclose(f);
+    return true;
+}
+
+#endif
@@ -0,0 +1,21 @@
+# Reader of the binary files of the event displays (see EventDisplayFile.h).
+# The file is mapped in memory: the arrays are views of the map, nothing is copied.
+import numpy as np
+
+MAGIC = 0x56454843  # "CHEV"
+MUON, PHOTONS, TRACE, HITS = 0, 1, 2, 3
+
+def load(file_name):
+    """Returns {evNumber: {kind: array of shape (nRows, nCols)}}"""
+    words = np.memmap(file_name, dtype='<f4', mode='r')
+    ints = words.view('<i4')
+    if len(ints) < 2 or ints[0] != MAGIC:
+        raise ValueError(file_name + " is not an event display file")
+    events = {}
+    pos = 2
+    while pos + 4 <= len(words):
+        evNumber, kind, nRows, nCols = (int(i) for i in ints[pos:pos+4])
+        pos += 4
+        events.setdefault(evNumber, {})[kind] = words[pos:pos+nRows*nCols].reshape(nRows, nCols)
+        pos += nRows*nCols
+    return events
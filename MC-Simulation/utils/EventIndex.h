@@ -0,0 +1,63 @@
+/************************************************************************
+*			EventIndex.h                    		*
+*************************************************************************
+* The simulation writes, next to the tree Cherenkov, the tree EventIndex	*
+* with one entry per event: evNumber, firstEntry and nEntries (the	*
+* muon and its photons). findEvent gives the entries of one event	*
+* without reading the tree Cherenkov.					*
+*************************************************************************/
+
+#ifndef EventIndex_h
+#define EventIndex_h
+
+#include <iostream>
+#include "TFile.h"
+#include "TTree.h"
+
+// Range of the entries of the event event_number: false if the event is not in the file
+bool findEvent( TFile* file, Int_t event_number, Long64_t &firstEntry, Long64_t &nEntries ) {
+    
+    Int_t    evNumber;
+    Long64_t first;
+    Int_t    n;
+    TTree* index = (TTree*)file->Get("EventIndex");
+    
+    if( index ) {
+        index->SetBranchAddress("evNumber",&evNumber);
+        index->SetBranchAddress("firstEntry",&first);
+        index->SetBranchAddress("nEntries",&n);
+        Long64_t nEvents = index->GetEntries();
+        if( nEvents == 0 ) return false;
+        //the events are saved in order: try first the entry event_number-evNumber(first event)
+        index->GetEntry(0);
+        Long64_t guess = (Long64_t)event_number - evNumber;
+        if( guess >= 0 && guess < nEvents ) index->GetEntry(guess);
+        if( evNumber != event_number ) {
+            index->BuildIndex("evNumber");
+            if( index->GetEntryWithIndex(event_number) <= 0 ) return false;
+        }
+        firstEntry = first;
+        nEntries   = n;
+        return true;
+    }
+    
+    //older files without EventIndex: scan only the branch evNumber of Cherenkov
+    std::cout << "No EventIndex in the file: scanning the tree" << std::endl;
+    TTree* tree = (TTree*)file->Get("Cherenkov");
+    TBranch* branch = tree->GetBranch("evNumber");
+    branch->SetAddress(&evNumber);
+    firstEntry = -1;
+    nEntries   = 0;
+    Long64_t nTree = tree->GetEntries();
+    for( Long64_t iEntry=0; iEntry<nTree; ++iEntry ) {
+        branch->GetEntry(iEntry);
+        if( evNumber == event_number ) {
+            if( firstEntry < 0 ) firstEntry = iEntry;
+            ++nEntries;
+        } else if( firstEntry >= 0 ) break;
+    }
+    tree->ResetBranchAddresses();
+    return firstEntry >= 0;
+}
+
+#endif